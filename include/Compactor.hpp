@@ -0,0 +1,110 @@
+#ifndef DLDI_COMPACTOR_HPP
+#define DLDI_COMPACTOR_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <DeltaStack.hpp>
+#include <WriteThrottle.hpp>
+
+namespace dldi {
+
+  struct CompactionPolicy {
+    /**
+     * Deltas of the same kind whose sizes are within a factor `tier_ratio` of each other form a tier.
+     * A tier of `min_tier_deltas` deltas is composed into a single delta.
+    */
+    double tier_ratio{4};
+    std::size_t min_tier_deltas{4};
+    /**
+     * All deltas are composed into the base once they add up to `max_delta_ratio` times its size,
+     * or once there are more than `max_deltas` of them, which bounds the work of a query.
+    */
+    double max_delta_ratio{0.1};
+    std::size_t max_deltas{16};
+    /**
+     * An upper bound on the average rate at which compactions write, in bytes per second (0 for no limit).
+     * Compactions are paced as they write each block, rather than delayed as a whole.
+    */
+    std::size_t max_bytes_per_second{0};
+    /**
+     * How often the stack is checked for work, besides when `notify` is called.
+    */
+    std::chrono::milliseconds poll_interval{1000};
+  };
+
+  /**
+   * The layers to compose into one, which replaces them in the stack.
+  */
+  struct Compaction {
+    std::vector<StackLayer> layers;
+    /**
+     * Whether the base is among the layers, which makes the output the new base.
+    */
+    bool major{false};
+  };
+
+  /**
+   * Composes the layers of a DeltaStack in the background, following a size-tiered policy.
+   * Since quantities are summed, the result of a stack doesn't depend on the order of its deltas,
+   * so additions are composed with additions and removals with removals wherever they are in the stack.
+  */
+  class Compactor {
+  public:
+    Compactor(DeltaStack& stack, const CompactionPolicy& policy = CompactionPolicy{});
+    /**
+     * Stops the background thread, after the compaction it may be running.
+    */
+    ~Compactor();
+    Compactor(const Compactor&) = delete;
+    auto operator=(const Compactor&) -> Compactor& = delete;
+
+    /**
+     * The next compaction the policy calls for, if any.
+    */
+    static auto plan(const std::vector<StackLayer>& layers, const CompactionPolicy& policy) -> std::optional<Compaction>;
+
+    /**
+     * Runs one compaction on the calling thread, if the policy calls for one.
+     * Returns whether it did. Compactions don't overlap, even with those of the background thread.
+    */
+    auto compact_once() -> bool;
+    /**
+     * Wake the background thread, e.g. after pushing a delta.
+    */
+    auto notify() -> void;
+    /**
+     * Blocks until the policy calls for no more compactions.
+     * Rethrows the error which stopped the background thread, if any.
+    */
+    auto wait_idle() -> void;
+
+  private:
+    DeltaStack* m_stack;
+    CompactionPolicy m_policy;
+    std::mutex m_mutex;
+    std::mutex m_compaction_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    bool m_stopping{false};
+    bool m_notified{false};
+    bool m_busy{false};
+    std::exception_ptr m_error;
+    /**
+     * Shared by all compactions, so that the rate holds across them, if there is a limit.
+    */
+    std::unique_ptr<WriteThrottle> m_throttle;
+    std::thread m_thread;
+
+    auto run() -> void;
+  };
+}
+
+#endif
@@ -5,18 +5,38 @@
 #include <dictionary/trie/Trie.hpp>
 #include <filesystem>
 #include <memory>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include <DLDI_enums.hpp>
 #include <dictionary/Dictionary.hpp>
 #include <QuantifiedTriple.hpp>
+#include <Statistics.hpp>
 #include <TriplesIterator.hpp>
 
 namespace dldi {
 
 
   class TriplesReader;
+  class WriteThrottle;
+
+  /**
+   * The terms of a triple: subject, predicate, object.
+  */
+  using TermTriple = std::tuple<std::string, std::string, std::string>;
+
+  /**
+   * Thrown when a source which is supposed to be sorted turns out not to be.
+  */
+  struct UnsortedInput : public std::runtime_error {
+    using std::runtime_error::runtime_error;
+  };
 
   struct SourceInfo {
     SourceType type;
@@ -54,6 +74,12 @@ namespace dldi {
     auto query_ptr(const dldi::TriplePattern& pattern) const -> std::shared_ptr<dldi::TriplesIterator>;
     auto query_ptr(const dldi::TripleOrder& order) const -> std::shared_ptr<dldi::TriplesIterator>;
 
+    /**
+     * Count the triples which match a given pattern, without iterating them. 
+     * Like `query_ptr`, this requires `prepare_for_query` to have been called.
+    */
+    auto count(const dldi::TriplePattern& pattern) const -> std::size_t;
+
     /**
      * Query for terms matching a given prefix in a given triple-term-position. 
     */
@@ -66,24 +92,66 @@ namespace dldi {
 
     auto string_to_id(const std::string& term, const dldi::TripleTermPosition& position) const -> std::size_t;
     auto id_to_string(const std::size_t& id, const dldi::TripleTermPosition& position) const -> std::string;
+    /**
+     * Like `id_to_string`, but appends to a buffer which can be reused.
+    */
+    auto append_string(const std::size_t& id, const dldi::TripleTermPosition& position, std::string& buffer) const -> void;
+    /**
+     * Decodes many IDs at once, see `Dictionary::decode`.
+    */
+    auto decode(std::span<const std::size_t> ids, const dldi::TripleTermPosition& position, std::string& buffer, std::vector<std::string_view>& terms) const -> void;
 
     /**
      * Compose a DLDI instance from sets of resources which should be added and subtracted.
+     * Unless `order_preserving_ids` is disabled, term IDs are reassigned in lexicographic order, 
+     * so that triples can be compared without dictionary lookups. 
+     * `memory_budget` applies when converting a single plaintext source, see `from_ptld`. 
+     * Merging uses up to `num_threads` threads. 
+     * With a `throttle`, the output of several sources is written no faster than it allows, block by block. 
     */
     static auto compose(
       const std::vector<std::filesystem::path>& additions,
       const std::vector<std::filesystem::path>& subtractions,
-      const std::filesystem::path& output_path) -> void;
+      const std::filesystem::path& output_path,
+      bool order_preserving_ids = true,
+      const std::size_t& memory_budget = 0,
+      const std::size_t& num_threads = std::thread::hardware_concurrency(),
+      WriteThrottle* throttle = nullptr) -> void;
 
     /**
      * Create a DLDI instance from a single plaintext linked data file. 
+     * With a nonzero `memory_budget` (in bytes), the input is built in runs of at most 
+     * roughly that size, which are spilled to disk and then composed into the output. 
     */
-    static auto from_ptld(const std::filesystem::path& input_path, const std::filesystem::path& output_path, const std::string& base_iri) -> void;
+    static auto from_ptld(const std::filesystem::path& input_path, const std::filesystem::path& output_path, const std::string& base_iri, const std::size_t& memory_budget = 0) -> void;
+
+    /**
+     * Create a DLDI instance from a plaintext linked data file whose statements are grouped by subject, 
+     * with subjects in lexicographic order of either their terms or their N-Triples form, 
+     * such as N-Triples sorted with `LC_ALL=C sort`. 
+     * The input is parsed on a single thread. Memory holds the predicate and object dictionaries, 
+     * and a translation of subject IDs; subject terms and each order are sorted in runs of at most 
+     * about `memory_budget` bytes (0 for no limit), and the subject trie is built in memory when they are merged. 
+     * Input which turns out not to be sorted like that throws `UnsortedInput`, leaving no output behind; 
+     * `from_ptld` builds it instead. 
+    */
+    static auto from_sorted_ptld(const std::filesystem::path& input_path, const std::filesystem::path& output_path, const std::string& base_iri, const std::size_t& memory_budget = 0) -> void;
+
+    /**
+     * Create a DLDI instance from triples in memory, given with their quantities. 
+    */
+    static auto from_statements(const std::vector<std::pair<dldi::TermTriple, std::size_t>>& statements, const std::filesystem::path& output_path) -> void;
 
     auto ensure_loaded(const dldi::TripleTermPosition& position) -> void;
 
     auto prepare_for_query(const dldi::TriplePattern& pattern) -> void;
     auto ensure_loaded_triples(const dldi::TripleOrder& order) -> void;
+    /**
+     * Loads the statistics which are saved along with the DLDI, 
+     * or computes them for DLDIs which were saved without. 
+    */
+    auto ensure_loaded_statistics() -> void;
+    auto statistics() const -> const dldi::Statistics&;
 
 
     auto get_dict(const dldi::TripleTermPosition& position) const -> std::shared_ptr<dldi::Dictionary> {
@@ -149,6 +217,7 @@ namespace dldi {
     std::shared_ptr<TriplesReader> m_triples_pso;
     std::shared_ptr<TriplesReader> m_triples_pos;
     std::shared_ptr<TriplesReader> m_triples_osp;
+    std::shared_ptr<Statistics> m_statistics;
     std::filesystem::path m_datadir;
     auto get_triples(const dldi::TripleOrder& order) const -> std::shared_ptr<TriplesReader>;
   };
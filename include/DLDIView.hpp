@@ -0,0 +1,226 @@
+#ifndef DLDI_VIEW_HPP
+#define DLDI_VIEW_HPP
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <DLDI.hpp>
+#include <Iterator.hpp>
+
+namespace dldi {
+
+  /**
+   * A DLDI whose triples and terms should be added to or removed from the view.
+  */
+  struct ViewDelta {
+    std::filesystem::path path;
+    bool removal{false};
+  };
+
+  /**
+   * A triple of the view with the net quantity its deltas add (positive) or remove (negative).
+  */
+  struct TripleChange {
+    QuantifiedTriple triple;
+    std::int64_t quantity;
+  };
+
+  /**
+   * Net quantities of triples to add (positive) or remove (negative), which are kept in memory rather than in a DLDI.
+  */
+  using BufferedChanges = std::map<dldi::TermTriple, std::int64_t>;
+
+  class DLDIView;
+  class ViewLayers;
+
+  /**
+   * The triples of the base and the deltas matching a pattern, merged with the buffered changes as they are read.
+   * Triples whose quantity drops to zero are skipped.
+  */
+  class ViewTriplesIterator final : public Iterator<QuantifiedTriple> {
+  public:
+    /**
+     * The triples of a delta, read in IDs of the view.
+    */
+    struct DeltaTriples {
+      std::shared_ptr<TriplesIterator> triples;
+      std::array<const dldi::IdMapping*, 3> ids;
+      bool removal{false};
+      auto read() const -> QuantifiedTriple;
+    };
+
+    ViewTriplesIterator(const DLDIView& view, std::shared_ptr<TriplesIterator> base, std::vector<DeltaTriples> deltas, std::span<const TripleChange> changes, const dldi::TripleOrder& order);
+    auto inner_proceed() -> void override;
+
+  private:
+    const DLDIView* m_view;
+    std::shared_ptr<TriplesIterator> m_base;
+    std::vector<DeltaTriples> m_deltas;
+    std::span<const TripleChange> m_changes;
+    std::size_t m_change_index{0};
+    dldi::TripleOrder m_order;
+    auto update_next() -> void;
+  };
+
+  /**
+   * The terms of the base and the deltas matching a prefix, merged with the buffered changes as they are read.
+   * Terms whose occurrences drop to zero are skipped.
+  */
+  class ViewTermIterator final : public Iterator<std::pair<std::string, std::size_t>> {
+  public:
+    ViewTermIterator(csd::TermStringIterator base, std::vector<std::pair<csd::TermStringIterator, bool>> deltas, std::span<const std::pair<std::string, std::int64_t>> changes);
+    auto inner_proceed() -> void override;
+
+  private:
+    csd::TermStringIterator m_base;
+    /**
+     * The terms of each delta, and whether it removes them.
+    */
+    std::vector<std::pair<csd::TermStringIterator, bool>> m_deltas;
+    std::span<const std::pair<std::string, std::int64_t>> m_changes;
+    std::size_t m_change_index{0};
+    auto update_next() -> void;
+  };
+
+  /**
+   * A base DLDI and a stack of deltas, along with the IDs which their terms have in views of them.
+   * Terms of the base keep their IDs. A term which only deltas have gets the ID it has in the first of them,
+   * offset past the largest ID of the base and of the deltas before.
+   *
+   * The IDs of each delta are translated once, when its dictionary is loaded, so views of the same layers
+   * share them, e.g. all views of a `DeltaStack` until its layers change. They are loaded lazily, and may be shared across threads.
+  */
+  class ViewLayers {
+  public:
+    /**
+     * `lease` is held for as long as the layers, e.g. to keep the files they read from being deleted.
+    */
+    ViewLayers(const std::filesystem::path& base, const std::vector<ViewDelta>& deltas, std::shared_ptr<const void> lease = nullptr);
+
+    /**
+     * Loads the dictionary of a position in the base and all deltas, and translates the IDs of the deltas.
+    */
+    auto ensure_loaded(const dldi::TripleTermPosition& position) -> void;
+    /**
+     * Loads a triple order in the base and all deltas, along with all dictionaries.
+    */
+    auto ensure_loaded_triples(const dldi::TripleOrder& order) -> void;
+
+  private:
+    friend class DLDIView;
+
+    struct Terms {
+      bool loaded{false};
+      /**
+       * The largest ID of the base, which has gaps unless its IDs are order-preserving.
+      */
+      std::size_t base_max_id{0};
+      /**
+       * For each delta, the sum of the largest IDs of the deltas before it.
+      */
+      std::vector<std::size_t> delta_offsets;
+      /**
+       * For each delta, the view ID of each of its IDs.
+      */
+      std::vector<dldi::IdMapping> delta_ids;
+      /**
+       * The largest ID of the layers, after which IDs of buffered terms follow.
+      */
+      std::size_t max_id{0};
+    };
+
+    // declared first, so that it is released after the DLDIs.
+    std::shared_ptr<const void> m_lease;
+    std::shared_ptr<DLDI> m_base;
+    std::vector<std::shared_ptr<DLDI>> m_deltas;
+    std::vector<bool> m_removals;
+    std::array<Terms, 3> m_terms;
+    std::set<dldi::TripleOrder> m_loaded_orders;
+    std::mutex m_mutex;
+
+    auto terms(const dldi::TripleTermPosition& position) const -> const Terms&;
+    auto string_to_id(const std::string& term, const dldi::TripleTermPosition& position) const -> std::size_t;
+    auto id_to_string(const std::size_t& id, const dldi::TripleTermPosition& position) const -> std::string;
+  };
+
+  /**
+   * A base DLDI with a stack of deltas applied on the fly, as if they had been composed.
+   * Nothing is rewritten: the triples and terms of the base and the deltas are merged as they are queried,
+   * with the deltas' IDs translated into the view's. This keeps updates cheap while the deltas are small
+   * compared to the base; `DLDI::compose` of the same sources turns the view into a DLDI of its own.
+   *
+   * IDs of the view are only order-preserving among the terms of the base, see `ViewLayers`.
+   * Changes which are buffered in memory apply on top of the deltas. Their terms which no layer has
+   * get IDs after those of the layers.
+   * As with composing, a delta must not remove more of a triple or term than the layers below it add.
+  */
+  class DLDIView {
+  public:
+    /**
+     * `lease` is held for as long as the view, e.g. to keep the files it reads from being deleted.
+    */
+    DLDIView(const std::filesystem::path& base, const std::vector<ViewDelta>& deltas, dldi::BufferedChanges buffer = {}, std::shared_ptr<const void> lease = nullptr);
+    /**
+     * A view of layers which other views may share.
+    */
+    explicit DLDIView(std::shared_ptr<ViewLayers> layers, dldi::BufferedChanges buffer = {});
+
+    auto query_ptr(const dldi::TriplePattern& pattern) const -> std::shared_ptr<dldi::ViewTriplesIterator>;
+    auto query_ptr(const dldi::TripleOrder& order) const -> std::shared_ptr<dldi::ViewTriplesIterator>;
+    auto query(const std::string& prefix, const dldi::TripleTermPosition& position) const -> dldi::ViewTermIterator;
+
+    auto string_to_id(const std::string& term, const dldi::TripleTermPosition& position) const -> std::size_t;
+    auto id_to_string(const std::size_t& id, const dldi::TripleTermPosition& position) const -> std::string;
+    /**
+     * Three-way comparison of the terms of two IDs of the view.
+    */
+    auto compare(const std::size_t& lhs, const std::size_t& rhs, const dldi::TripleTermPosition& position) const -> int;
+    auto compare(const QuantifiedTriple& lhs, const QuantifiedTriple& rhs, const dldi::TripleOrder& order) const -> int;
+
+    /**
+     * Loads the dictionary of a position in the layers, and the buffered terms.
+    */
+    auto ensure_loaded(const dldi::TripleTermPosition& position) -> void;
+    /**
+     * Loads a triple order in the layers, along with all dictionaries, and sorts the buffered changes in that order.
+    */
+    auto ensure_loaded_triples(const dldi::TripleOrder& order) -> void;
+    auto prepare_for_query(const dldi::TriplePattern& pattern) -> void;
+
+  private:
+    struct BufferedTerms {
+      bool loaded{false};
+      /**
+       * The buffered terms which no layer has, in term order. Their IDs follow those of the layers.
+      */
+      std::vector<std::string> new_terms;
+      std::unordered_map<std::string, std::size_t> new_ids;
+      /**
+       * The net change in occurrences of each buffered term, in term order.
+      */
+      std::vector<std::pair<std::string, std::int64_t>> changes;
+    };
+
+    std::shared_ptr<ViewLayers> m_layers;
+    dldi::BufferedChanges m_buffer;
+    std::array<BufferedTerms, 3> m_terms;
+    /**
+     * For each order, the buffered changes to triples, sorted in that order.
+    */
+    std::map<dldi::TripleOrder, std::vector<TripleChange>> m_changes;
+
+    auto terms(const dldi::TripleTermPosition& position) const -> const BufferedTerms&;
+  };
+}
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef DLDI_DELTA_STACK_HPP
+#define DLDI_DELTA_STACK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <DLDIView.hpp>
+
+namespace dldi {
+
+  struct StackLayer {
+    /**
+     * The name of the layer's DLDI directory within the stack.
+    */
+    std::string name;
+    bool removal{false};
+    /**
+     * The size of the layer's triples, like `SourceInfo::size` of a DLDI.
+    */
+    std::size_t size{0};
+  };
+
+  /**
+   * A directory holding a base DLDI and a stack of deltas to add or remove, which is queried through a DLDIView.
+   * A manifest lists the layers, base first. It is replaced with a rename on every change,
+   * so that the layers it lists are always complete.
+   *
+   * Triples can also be inserted and removed one by one. These changes are buffered in memory, where views see them right away,
+   * and appended to a write-ahead log, which is replayed when the stack is opened again.
+   * Once enough changes are buffered, they are flushed into deltas.
+   *
+   * Layers which a compaction replaces leave the manifest right away, but their directories are only deleted
+   * once the last view created with them is destroyed, since views load dictionaries and orders lazily.
+  */
+  class DeltaStack {
+  public:
+    /**
+     * Open an existing stack.
+    */
+    DeltaStack(const std::filesystem::path& dir, const std::size_t& flush_threshold = 100000);
+    ~DeltaStack();
+
+    /**
+     * Create a stack in a new directory, with a copy of a DLDI as its base.
+    */
+    static auto create(const std::filesystem::path& dir, const std::filesystem::path& base) -> void;
+
+    /**
+     * Move a DLDI onto the top of the stack, to be added or removed.
+    */
+    auto push(const std::filesystem::path& delta, bool removal = false) -> void;
+
+    /**
+     * Add or remove one occurrence of a triple. The change is durable once this returns.
+     * Removing a triple which the stack doesn't hold throws, and changes nothing.
+     * Buffering more than `flush_threshold` distinct triples flushes them.
+    */
+    auto insert(const std::string& subject, const std::string& predicate, const std::string& object) -> void;
+    auto remove(const std::string& subject, const std::string& predicate, const std::string& object) -> void;
+    /**
+     * Write the buffered changes to a delta of additions and one of removals, and start a new log.
+    */
+    auto flush() -> void;
+
+    /**
+     * The current layers, base first.
+    */
+    auto layers() const -> std::vector<StackLayer>;
+    auto layer_path(const StackLayer& layer) const -> std::filesystem::path;
+    /**
+     * A view of the current layers and buffered changes.
+    */
+    auto view() const -> dldi::DLDIView;
+
+    /**
+     * A path within the stack for the output of a compaction, which isn't used by any layer.
+    */
+    auto new_layer() -> StackLayer;
+    /**
+     * Replace some layers by one which holds their composition. The replacement takes the place of the first of them,
+     * which is the base when the base is replaced. Layers pushed in the meantime are kept.
+     * The replaced layers are deleted once no view uses them.
+    */
+    auto replace(const std::vector<StackLayer>& replaced, StackLayer replacement) -> void;
+
+  private:
+    /**
+     * Shared by the views of a layer, and deletes the layer's directory once it is retired and the last of them is gone.
+    */
+    struct LayerLease;
+
+    std::filesystem::path m_dir;
+    std::vector<StackLayer> m_layers;
+    /**
+     * The leases of the current layers which views were created with, by name.
+    */
+    mutable std::map<std::string, std::shared_ptr<LayerLease>> m_leases;
+    /**
+     * The layers which views share, with their translated IDs, until the layers change.
+    */
+    mutable std::shared_ptr<dldi::ViewLayers> m_view_layers;
+    std::size_t m_next_layer{0};
+    std::size_t m_flush_threshold;
+    dldi::BufferedChanges m_buffer;
+    /**
+     * The name of the write-ahead log of the buffered changes, if any.
+    */
+    std::string m_wal;
+    int m_wal_fd{-1};
+    mutable std::mutex m_mutex;
+
+    auto manifest_path() const -> std::filesystem::path {
+      return m_dir / "manifest";
+    }
+    auto save_manifest() const -> void;
+    /**
+     * Replace the manifest with one listing `layers` and `wal`. It is on disk, but the rename may not be until the directory is synced.
+    */
+    auto write_manifest(const std::vector<StackLayer>& layers, const std::string& wal) const -> void;
+    auto next_layer_name() -> std::string;
+    auto replay_wal() -> void;
+    auto append(const dldi::TermTriple& triple, const std::int64_t& quantity) -> void;
+    auto flush_unlocked() -> void;
+    auto view_unlocked(dldi::BufferedChanges buffer) const -> dldi::DLDIView;
+    /**
+     * The net quantity of a triple in the layers and the buffered changes.
+    */
+    auto quantity_unlocked(const dldi::TermTriple& triple) -> std::int64_t;
+    auto layer_size(const std::string& name) const -> std::size_t;
+  };
+}
+
+#endif
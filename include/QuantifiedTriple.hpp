@@ -1,8 +1,10 @@
 #ifndef DLDI_QUANTIFIED_TRIPLE_HPP
 #define DLDI_QUANTIFIED_TRIPLE_HPP
 
+#include <array>
 #include <cassert>
 #include <iostream>
+#include <tuple>
 
 #include <dictionary/Dictionary.hpp>
 #include <DLDI_enums.hpp>
@@ -141,69 +143,138 @@ namespace dldi {
       throw std::runtime_error("Unrecognized order");
     }
 
-    auto precedes(
+    /**
+     * Three-way comparison with the range of triples which match the pattern, in the given order: 
+     * negative before the range, zero within it, positive after it. 
+     * The pattern's fixed terms must form a prefix of the order (see DLDI::decide_order_from_triple_pattern). 
+    */
+    auto compare_to(
       const dldi::TriplePattern& pattern,
       const dldi::TripleOrder& order,
       const dldi::Dictionary& subjects,
       const dldi::Dictionary& predicates,
-      const dldi::Dictionary& objects) const -> bool {
-      const auto s{std::get<0>(pattern)};
-      const auto p{std::get<1>(pattern)};
-      const auto o{std::get<2>(pattern)};
-      if (s == 0 && p == 0 && o == 0) {
+      const dldi::Dictionary& objects) const -> int {
+      const auto [lhs0, lhs1, lhs2]{key(order)};
+      const auto [rhs0, rhs1, rhs2]{QuantifiedTriple{std::get<0>(pattern), std::get<1>(pattern), std::get<2>(pattern), 0}.key(order)};
+      const std::size_t lhs[3]{lhs0, lhs1, lhs2};
+      const std::size_t rhs[3]{rhs0, rhs1, rhs2};
+      if (rhs[0] == 0) {
         throw std::runtime_error("All wildcards");
       }
-      if (s == 0 && p == 0 && o != 0) {
-        assert(order == dldi::TripleOrder::OSP);
-        const auto objectComparison{objects.compare(object(), o)};
-        return objectComparison < 0;
-      }
-      if (s == 0 && p != 0 && o == 0) {
-        assert(order == dldi::TripleOrder::PSO);
-        const auto predicateComparison{predicates.compare(predicate(), p)};
-        return predicateComparison < 0;
-      }
-      if (s == 0 && p != 0 && o != 0) {
-        assert(order == dldi::TripleOrder::POS);
-        const auto predicateComparison{predicates.compare(predicate(), p)};
-        if (predicateComparison != 0)
-          return predicateComparison < 0;
-        const auto objectComparison{objects.compare(object(), o)};
-        return objectComparison < 0;
-      }
-      if (s != 0 && p == 0 && o == 0) {
-        assert(order == dldi::TripleOrder::SPO);
-        const auto subjectComparison{subjects.compare(subject(), s)};
-        return subjectComparison < 0;
-      }
-      if (s != 0 && p == 0 && o != 0) {
-        assert(order == dldi::TripleOrder::SOP);
-        const auto subjectComparison{subjects.compare(subject(), s)};
-        if (subjectComparison != 0)
-          return subjectComparison < 0;
-        const auto objectComparison{objects.compare(object(), o)};
-        return objectComparison < 0;
+      const auto positions{key_positions(order)};
+      for (auto i{0}; i < 3 && rhs[i] != 0; i++) {
+        const auto& dict{positions[i] == dldi::TripleTermPosition::subject ? subjects : positions[i] == dldi::TripleTermPosition::predicate ? predicates :
+                                                                                                                                              objects};
+        const auto comparison{dict.compare(lhs[i], rhs[i])};
+        if (comparison != 0)
+          return comparison;
       }
-      if (s != 0 && p != 0 && o == 0) {
-        assert(order == dldi::TripleOrder::SPO);
-        const auto subjectComparison{subjects.compare(subject(), s)};
-        if (subjectComparison != 0)
-          return subjectComparison < 0;
-        const auto predicateComparison{predicates.compare(predicate(), p)};
-        return predicateComparison < 0;
+      return 0;
+    }
+
+    auto precedes(
+      const dldi::TriplePattern& pattern,
+      const dldi::TripleOrder& order,
+      const dldi::Dictionary& subjects,
+      const dldi::Dictionary& predicates,
+      const dldi::Dictionary& objects) const -> bool {
+      return compare_to(pattern, order, subjects, predicates, objects) < 0;
+    }
+
+    auto succeeds(
+      const dldi::TriplePattern& pattern,
+      const dldi::TripleOrder& order,
+      const dldi::Dictionary& subjects,
+      const dldi::Dictionary& predicates,
+      const dldi::Dictionary& objects) const -> bool {
+      return compare_to(pattern, order, subjects, predicates, objects) > 0;
+    }
+
+    /**
+     * The triple-term positions of the components of `key`. 
+    */
+    static auto key_positions(const dldi::TripleOrder& order) -> std::array<dldi::TripleTermPosition, 3> {
+      using enum dldi::TripleTermPosition;
+      if (order == dldi::TripleOrder::SPO)
+        return {subject, predicate, object};
+      if (order == dldi::TripleOrder::SOP)
+        return {subject, object, predicate};
+      if (order == dldi::TripleOrder::PSO)
+        return {predicate, subject, object};
+      if (order == dldi::TripleOrder::POS)
+        return {predicate, object, subject};
+      if (order == dldi::TripleOrder::OSP)
+        return {object, subject, predicate};
+      throw std::runtime_error("Unrecognized order");
+    }
+
+    /**
+     * The triple's IDs, in the given order. 
+    */
+    auto key(const dldi::TripleOrder& order) const -> std::tuple<std::size_t, std::size_t, std::size_t> {
+      if (order == dldi::TripleOrder::SPO)
+        return {subject(), predicate(), object()};
+      if (order == dldi::TripleOrder::SOP)
+        return {subject(), object(), predicate()};
+      if (order == dldi::TripleOrder::PSO)
+        return {predicate(), subject(), object()};
+      if (order == dldi::TripleOrder::POS)
+        return {predicate(), object(), subject()};
+      if (order == dldi::TripleOrder::OSP)
+        return {object(), subject(), predicate()};
+      throw std::runtime_error("Unrecognized order");
+    }
+
+    /**
+     * Inverse of `key`.
+    */
+    static auto from_key(const std::tuple<std::size_t, std::size_t, std::size_t>& key, const dldi::TripleOrder& order, const std::size_t& quantity) -> QuantifiedTriple {
+      const auto [a, b, c]{key};
+      if (order == dldi::TripleOrder::SPO)
+        return QuantifiedTriple{a, b, c, quantity};
+      if (order == dldi::TripleOrder::SOP)
+        return QuantifiedTriple{a, c, b, quantity};
+      if (order == dldi::TripleOrder::PSO)
+        return QuantifiedTriple{b, a, c, quantity};
+      if (order == dldi::TripleOrder::POS)
+        return QuantifiedTriple{c, a, b, quantity};
+      if (order == dldi::TripleOrder::OSP)
+        return QuantifiedTriple{b, c, a, quantity};
+      throw std::runtime_error("Unrecognized order");
+    }
+
+    /**
+     * Counterpart of `smaller_or_equal_to` which compares IDs rather than terms. 
+     * Only valid when all dictionaries have order-preserving IDs. 
+    */
+    auto smaller_than(const dldi::QuantifiedTriple& rhs, const dldi::TripleOrder& order) const -> bool {
+      return key(order) < rhs.key(order);
+    }
+
+    /**
+     * Counterpart of `compare_to` which compares IDs rather than terms. 
+     * Only valid when the dictionaries of the pattern's fixed terms have order-preserving IDs. 
+    */
+    auto compare_to(const dldi::TriplePattern& pattern, const dldi::TripleOrder& order) const -> int {
+      const auto [lhs0, lhs1, lhs2]{key(order)};
+      const auto [rhs0, rhs1, rhs2]{QuantifiedTriple{std::get<0>(pattern), std::get<1>(pattern), std::get<2>(pattern), 0}.key(order)};
+      const std::size_t lhs[3]{lhs0, lhs1, lhs2};
+      const std::size_t rhs[3]{rhs0, rhs1, rhs2};
+      if (rhs[0] == 0) {
+        throw std::runtime_error("All wildcards");
       }
-      if (s != 0 && p != 0 && o != 0) {
-        assert(order == dldi::TripleOrder::SPO);
-        const auto subjectComparison{subjects.compare(subject(), s)};
-        if (subjectComparison != 0)
-          return subjectComparison < 0;
-        const auto predicateComparison{predicates.compare(predicate(), p)};
-        if (predicateComparison != 0)
-          return predicateComparison < 0;
-        const auto objectComparison{objects.compare(object(), o)};
-        return objectComparison < 0;
+      // the pattern's wildcards (0) always come after its fixed terms in the given order.
+      for (auto i{0}; i < 3 && rhs[i] != 0; i++) {
+        if (lhs[i] != rhs[i])
+          return lhs[i] < rhs[i] ? -1 : 1;
       }
-      throw std::runtime_error("surprise");
+      return 0;
+    }
+    auto precedes(const dldi::TriplePattern& pattern, const dldi::TripleOrder& order) const -> bool {
+      return compare_to(pattern, order) < 0;
+    }
+    auto succeeds(const dldi::TriplePattern& pattern, const dldi::TripleOrder& order) const -> bool {
+      return compare_to(pattern, order) > 0;
     }
 
     auto set_quantity(const std::size_t& quantity) {
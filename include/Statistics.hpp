@@ -0,0 +1,118 @@
+#ifndef DLDI_STATISTICS_HPP
+#define DLDI_STATISTICS_HPP
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <DLDI_enums.hpp>
+#include <QuantifiedTriple.hpp>
+
+namespace dldi {
+
+  struct PredicateStatistics {
+    std::size_t triples{0};
+    std::size_t distinct_subjects{0};
+    std::size_t distinct_objects{0};
+  };
+
+  /**
+   * The subjects which have exactly a given set of predicates.
+  */
+  struct CharacteristicSet {
+    /**
+     * Predicate IDs, ascending.
+    */
+    std::vector<std::size_t> predicates;
+    std::size_t subjects{0};
+    std::size_t triples{0};
+  };
+
+  /**
+   * Distributions of the data in a DLDI, for choosing between the triple orders without probing them.
+   * Triples are counted once each, regardless of their quantity.
+  */
+  struct Statistics {
+    /**
+     * At most this many characteristic sets are kept, the most common ones.
+    */
+    static constexpr std::size_t MAX_CHARACTERISTIC_SETS{10000};
+
+    std::size_t triples{0};
+    /**
+     * By predicate ID.
+    */
+    std::map<std::size_t, PredicateStatistics> predicates;
+    /**
+     * For subjects, predicates and objects, the number of terms by the binary logarithm of their occurrences:
+     * entry k counts the terms with [2^k, 2^(k+1)) occurrences.
+    */
+    std::array<std::vector<std::size_t>, 3> occurrence_histograms;
+    /**
+     * The most common first.
+    */
+    std::vector<CharacteristicSet> characteristic_sets;
+
+    /**
+     * Compute the statistics of a DLDI, from its dictionaries and the SPO, PSO and POS orders.
+    */
+    static auto compute(const std::filesystem::path& dldi_dir) -> Statistics;
+    static auto load(const std::filesystem::path& path) -> Statistics;
+    auto save(const std::filesystem::path& path) const -> void;
+
+    static auto statistics_file_path(const std::filesystem::path& dldi_dir) -> std::filesystem::path {
+      return dldi_dir.string() + "/statistics";
+    }
+  };
+
+  /**
+   * Gathers statistics from the triples of the PSO, POS and SPO orders as they are written, each in its order.
+   * The orders are counted separately, so each may be written on a thread of its own.
+  */
+  class StatisticsCollector {
+  public:
+    /**
+     * At most this many characteristic sets are counted at a time.
+     * Once there are as many, a new set replaces the least common one and carries on from its counts (space-saving),
+     * so counts are upper bounds, which are exact for sets which never replaced another.
+    */
+    static constexpr std::size_t MAX_COUNTED_CHARACTERISTIC_SETS{4 * Statistics::MAX_CHARACTERISTIC_SETS};
+
+    /**
+     * Count a triple of `order`. Triples of the other orders are ignored.
+    */
+    auto add(const dldi::TripleOrder& order, const QuantifiedTriple& triple) -> void;
+    /**
+     * The statistics of the triples of all three orders, with the histograms of the dictionaries in `dldi_dir`.
+    */
+    auto finish(const std::filesystem::path& dldi_dir) -> Statistics;
+
+  private:
+    struct PredicateSetHash {
+      auto operator()(const std::vector<std::size_t>& predicates) const -> std::size_t;
+    };
+    auto finish_subject() -> void;
+
+    std::size_t m_triples{0};
+    std::map<std::size_t, PredicateStatistics> m_predicates;
+    QuantifiedTriple m_previous_pso;
+    std::map<std::size_t, std::size_t> m_distinct_objects;
+    QuantifiedTriple m_previous_pos;
+
+    std::size_t m_subject{0};
+    std::vector<std::size_t> m_subject_predicates;
+    std::size_t m_subject_triples{0};
+    /**
+     * The counted sets by their predicates, whose `predicates` are only filled in when finishing.
+    */
+    std::unordered_map<std::vector<std::size_t>, CharacteristicSet, PredicateSetHash> m_sets;
+    std::set<std::pair<std::size_t, const std::vector<std::size_t>*>> m_sets_by_subjects;
+  };
+}
+
+#endif
@@ -1,20 +1,50 @@
 #ifndef DLDI_TRIPLES_ITERATOR_HPP
 #define DLDI_TRIPLES_ITERATOR_HPP
 
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
 #include <Iterator.hpp>
+#include <QuantifiedTriple.hpp>
 
 namespace dldi {
 
-  class TriplesIterator : public Iterator<QuantifiedTriple> {
+  class TriplesReader;
+
+  class TriplesIterator final : public Iterator<QuantifiedTriple> {
   public:
-    TriplesIterator(const QuantifiedTriple* const triples, const TriplePattern& m_pattern, const std::size_t& num_triples, const Dictionary& subjects, const Dictionary& predicates, const Dictionary& objects);
+    TriplesIterator(const TriplesReader& reader, const TriplePattern& pattern, const Dictionary& subjects, const Dictionary& predicates, const Dictionary& objects);
     auto inner_proceed() -> void override;
+    /**
+     * Fill `out` with the next results, starting with the one `read()` would return, 
+     * and proceed past them. Returns the number of results written, which is only 
+     * smaller than `out.size()` once the results are depleted. 
+     * Whole blocks are decoded straight into `out`. 
+    */
+    auto next_batch(std::span<QuantifiedTriple> out) -> std::size_t;
+    /**
+     * The positions [begin, end) of the results in the triples file. 
+    */
+    auto range() const -> std::pair<std::size_t, std::size_t>;
+    /**
+     * The total number of results, known without iterating them. 
+    */
+    auto count() const -> std::size_t;
 
   private:
-    const QuantifiedTriple* const m_triples;
-    const TriplePattern m_pattern;
+    const TriplesReader* m_reader;
+    std::size_t m_begin;
+    std::size_t m_end;
     std::size_t m_index;
-    std::size_t m_num_triples;
+    /**
+     * The decoded triples of the block which holds m_index.
+    */
+    std::vector<QuantifiedTriple> m_block;
+    std::size_t m_block_index;
+    auto load_block(const std::size_t& block) -> void;
+    auto update_next() -> void;
   };
 }
-#endif 
\ No newline at end of file
+#endif
@@ -0,0 +1,32 @@
+#ifndef DLDI_WRITE_THROTTLE_HPP
+#define DLDI_WRITE_THROTTLE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace dldi {
+
+  /**
+   * Paces writes to at most `bytes_per_second` on average, by making writers which get ahead sleep.
+   * The threads writing the files of a DLDI share one throttle.
+  */
+  class WriteThrottle {
+  public:
+    explicit WriteThrottle(const std::size_t& bytes_per_second);
+    /**
+     * Account for `bytes` which were just written, and sleep until the rate allows them.
+    */
+    auto wrote(const std::size_t& bytes) -> void;
+
+  private:
+    const std::size_t m_bytes_per_second;
+    std::mutex m_mutex;
+    /**
+     * When the writes accounted for so far are within the rate.
+    */
+    std::chrono::steady_clock::time_point m_paid_until;
+  };
+}
+
+#endif
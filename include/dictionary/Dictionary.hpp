@@ -2,7 +2,9 @@
 #define DLDI_DICT_HPP
 
 #include <filesystem>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <DLDI_enums.hpp>
@@ -11,6 +13,12 @@
 #include <dictionary/trie/Trie.hpp>
 
 namespace dldi {
+  /**
+   * Maps IDs of one dictionary (the index) to IDs of another. 
+   * Index 0 is unused, since 0 is never a valid ID. 
+  */
+  using IdMapping = std::vector<std::size_t>;
+
   class Dictionary {
   public:
     Dictionary(const std::filesystem::path& path);
@@ -18,15 +26,50 @@ namespace dldi {
     ~Dictionary();
     auto string_to_id(const std::string& string) const -> std::size_t;
     auto id_to_string(const std::size_t& id) const -> std::string;
+    /**
+     * Appends the term of an ID to `buffer`, so that a buffer can be reused across lookups.
+    */
+    auto append_string(const std::size_t& id, std::string& buffer) const -> void;
+    /**
+     * Appends the terms of many IDs to `buffer`, and sets `terms` to views of them, in the order of `ids`.
+     * IDs are decoded in sorted order, sharing the walks up the trie of terms with common prefixes.
+     * The views are valid until `buffer` is changed.
+    */
+    auto decode(std::span<const std::size_t> ids, std::string& buffer, std::vector<std::string_view>& terms) const -> void;
     auto query(const std::string& prefix) const -> csd::TermStringIterator;
     auto add(const std::string& term, const std::size_t& quantity) -> std::size_t;
     auto remove(const std::string& term, const std::size_t& quantity) -> void;
-    auto save(const std::filesystem::path& path) -> void;
+    /**
+     * Adds all terms of another dictionary, with their quantities.
+     * Returns the translation of the other dictionary's IDs to IDs of this one.
+    */
+    auto merge(const Dictionary& other) -> dldi::IdMapping;
+    /**
+     * With order-preserving IDs, the IDs of the saved dictionary are 
+     * assigned in lexicographic order of their terms. 
+     * Use `lexicographic_ids` beforehand to translate IDs which are already in use. 
+    */
+    auto save(const std::filesystem::path& path, bool order_preserving_ids = true) -> void;
+    auto has_order_preserving_ids() const -> bool;
+    auto lexicographic_ids() const -> dldi::IdMapping;
+    /**
+     * Entry k counts the terms with [2^k, 2^(k+1)) occurrences.
+    */
+    auto occurrence_histogram() const -> std::vector<std::size_t>;
+    /**
+     * An estimate of the heap memory taken by terms added since loading (or since construction). 
+     * Memory-mapped terms are not counted.
+    */
+    auto memory_usage() const -> std::size_t;
 
     auto compare(const std::size_t& lhs, const std::size_t& rhs) const -> int;
     auto compare(const std::size_t& lhs, const std::size_t& rhs, const std::shared_ptr<dldi::Dictionary> rhs_dict) const -> int;
 
     auto size() const -> std::size_t;
+    /**
+     * The largest ID of any term. Without order-preserving IDs, IDs may have gaps, so this may exceed `size`.
+    */
+    auto max_id() const -> std::size_t;
 
     static auto dictionary_file_path(const std::filesystem::path& dldi_dir, const dldi::TripleTermPosition& position) -> std::filesystem::path {
       return dldi_dir.string() + "/" + EnumMapping::position_to_string(position) + "s.dictionary";
@@ -24,7 +24,7 @@ namespace csd {
     auto inner_proceed() -> void override;
 
   private:
-    const DataManager* const m_data;
+    const DataManager* m_data;
     std::size_t* m_ptr;
     std::size_t* m_tooFar;
   };
@@ -39,7 +39,7 @@ namespace csd {
     auto inner_proceed() -> void override;
 
   private:
-    const DataManager* const m_data;
+    const DataManager* m_data;
     NewOutEdgesList m_newEdges;
     std::size_t m_newEdgesIndex;
   };
@@ -47,6 +47,7 @@ namespace csd {
   /**
    * @brief Iterator over all outedges
    *
+   * A value type, which can be reassigned to iterate over another node without allocating.
    */
   class OutEdgeIterator : public dldi::Iterator<std::size_t> {
   public:
@@ -54,8 +55,7 @@ namespace csd {
     auto inner_proceed() -> void override;
 
   private:
-    const DataManager* const m_data;
-    std::vector<dldi::Iterator<std::size_t>*> m_iterators;
+    const DataManager* m_data;
 
     auto sort_iterators() -> void;
 
@@ -14,10 +14,20 @@ namespace csd {
   public:
     TermIterator(const DataManager* const data, const std::string& prefix);
     auto inner_proceed() -> void override;
+    /**
+     * The term of the leaf which `read` returns.
+     * It is built up along the traversal, by appending labels on the way down and truncating on the way back.
+    */
+    [[nodiscard]] auto term() const -> const std::string&;
 
   private:
     std::size_t m_scope;
     std::vector<csd::OutEdgeIterator> m_iterators;
+    /**
+     * The length of the term up to the node of each iterator.
+    */
+    std::vector<std::size_t> m_termLengths;
+    std::string m_term;
     const DataManager* m_data;
   };
 }
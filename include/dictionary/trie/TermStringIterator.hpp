@@ -16,6 +16,10 @@ namespace csd {
 
     // protected:
     auto inner_proceed() -> void override;
+    /**
+     * The ID of the term which `read` returns. 
+    */
+    auto id() const -> std::size_t;
 
   private:
     std::size_t m_scope;
@@ -3,7 +3,11 @@
 
 #define TRIE 7
 
+#include <array>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <dictionary/trie/DataTypes.hpp>
@@ -21,7 +25,42 @@ namespace csd {
     std::size_t numEdges;
   } __attribute__((aligned(64)));
 
-  using TriePath = std::vector<std::pair<std::size_t, Edge* const>>;
+  /**
+   * The edges from a leaf up to the root, as pairs of edge ID and edge.
+   * Up to `INLINE_CAPACITY` edges are kept in place, so extracting a path doesn't allocate for the depths tries have in practice.
+   */
+  class TriePath {
+  public:
+    using Segment = std::pair<std::size_t, const Edge*>;
+    static constexpr std::size_t INLINE_CAPACITY{64};
+
+    auto push_back(const Segment& segment) -> void {
+      if (m_size < INLINE_CAPACITY) {
+        m_inline[m_size] = segment;
+      } else {
+        m_overflow.push_back(segment);
+      }
+      m_size++;
+    }
+    [[nodiscard]] auto at(const std::size_t& index) const -> const Segment& {
+      if (index >= m_size) {
+        throw std::out_of_range("Trie path index out of range");
+      }
+      return index < INLINE_CAPACITY ? m_inline[index] : m_overflow[index - INLINE_CAPACITY];
+    }
+    [[nodiscard]] auto size() const -> std::size_t {
+      return m_size;
+    }
+    auto clear() -> void {
+      m_overflow.clear();
+      m_size = 0;
+    }
+
+  private:
+    std::array<Segment, INLINE_CAPACITY> m_inline;
+    std::vector<Segment> m_overflow;
+    std::size_t m_size{0};
+  };
 
   class Trie {
   public:
@@ -30,14 +69,21 @@ namespace csd {
 
     [[nodiscard]] auto string_to_id(const std::string& str) const -> std::size_t;
     auto id_to_string(const std::size_t& id) const -> const std::string;
+    auto append_string(const std::size_t& id, std::string& buffer) const -> void;
+    auto decode(std::span<const std::size_t> ids, std::string& buffer, std::vector<std::string_view>& terms) const -> void;
 
-    auto save(std::ostream& fp) -> void;
+    auto save(std::ostream& fp, bool orderPreservingIds = true) -> void;
     auto load(unsigned char* ptr) -> void;
 
     auto print(std::size_t id = 0) const -> void;
 
     auto insert(const std::string& rdfTerm, const std::size_t& occurences = 1) -> std::pair<std::size_t, bool>;
     auto remove(const std::size_t& id, const std::size_t& occurrences = 1) -> bool;
+    /**
+     * Adds all terms of another trie, with their occurrences.
+     * Returns the ID in this trie of each ID of the other (index 0 is unused).
+     */
+    auto merge(const Trie& other) -> std::vector<std::size_t>;
 
     [[nodiscard]] auto suggestions(const std::string& prefix) const -> TermStringIterator;
 
@@ -58,6 +104,27 @@ namespace csd {
 
     void addOccurrences(const std::size_t& id, const std::size_t& occurences);
 
+    /**
+     * Whether comparing two IDs is equivalent to comparing the terms they represent.
+     */
+    [[nodiscard]] auto hasOrderPreservingIds() const -> bool;
+    /**
+     * The largest ID of any term, which may exceed the number of terms when IDs have gaps.
+     */
+    [[nodiscard]] auto maxId() const -> std::size_t;
+    /**
+     * Maps each current ID to the ID it will have after an order-preserving save.
+     */
+    [[nodiscard]] auto lexicographicIds() const -> std::vector<std::size_t>;
+    /**
+     * Entry k counts the terms with [2^k, 2^(k+1)) occurrences.
+     */
+    [[nodiscard]] auto occurrenceHistogram() const -> std::vector<std::size_t>;
+    /**
+     * An estimate of the heap memory of the terms added since loading.
+     */
+    [[nodiscard]] auto memoryUsage() const -> std::size_t;
+
   private:
     DataManager* const m_data;
   };
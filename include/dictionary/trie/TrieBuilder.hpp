@@ -0,0 +1,46 @@
+#ifndef CSD_TRIE_BUILDER_HPP
+#define CSD_TRIE_BUILDER_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <dictionary/trie/DataTypes.hpp>
+
+namespace csd {
+
+  /**
+   * Builds a trie from terms given in lexicographic order, in one pass.
+   * Nodes, edges and labels are laid out as `Trie::save` writes them, with order-preserving IDs,
+   * so the result is written without any further traversal.
+   * A term equal to the previous one adds to its occurrences.
+   */
+  class TrieBuilder {
+  public:
+    TrieBuilder();
+
+    auto add(const std::string& term, const std::size_t& occurrences = 1) -> void;
+    auto save(std::ostream& fp) const -> void;
+
+    [[nodiscard]] auto numTerms() const -> std::size_t;
+
+  private:
+    std::vector<Edge> m_edges;
+    std::vector<LeafNode> m_leaves;
+    std::vector<InternalNode> m_internals;
+    std::string m_labels;
+    /**
+     * The edges from the root to the leaf of the previous term.
+     */
+    std::vector<std::size_t> m_path;
+    /**
+     * The previous term, including its terminating null byte.
+     */
+    std::string m_previous;
+
+    auto addOutEdge(const std::size_t& nodeId) -> void;
+  };
+}
+
+#endif
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <map>
+
+#include <Compactor.hpp>
+
+namespace dldi {
+  Compactor::Compactor(DeltaStack& stack, const CompactionPolicy& policy)
+    : m_stack{&stack},
+      m_policy{policy},
+      m_throttle{policy.max_bytes_per_second == 0 ? nullptr : std::make_unique<WriteThrottle>(policy.max_bytes_per_second)},
+      m_thread{&Compactor::run, this} {
+  }
+
+  Compactor::~Compactor() {
+    {
+      std::lock_guard lock{m_mutex};
+      m_stopping = true;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+  }
+
+  auto Compactor::plan(const std::vector<StackLayer>& layers, const CompactionPolicy& policy) -> std::optional<Compaction> {
+    if (layers.size() < 2) {
+      return std::nullopt;
+    }
+    std::size_t delta_size{0};
+    for (std::size_t i{1}; i < layers.size(); i++) {
+      delta_size += layers[i].size;
+    }
+    if (layers.size() - 1 > policy.max_deltas || static_cast<double>(delta_size) > policy.max_delta_ratio * static_cast<double>(layers[0].size)) {
+      return Compaction{layers, true};
+    }
+
+    // tiers by the logarithm of the size, separately for additions and removals.
+    std::map<std::pair<bool, long>, std::vector<StackLayer>> tiers;
+    for (std::size_t i{1}; i < layers.size(); i++) {
+      const auto tier{static_cast<long>(std::floor(std::log(static_cast<double>(std::max<std::size_t>(layers[i].size, 1))) / std::log(policy.tier_ratio)))};
+      auto& members{tiers[{layers[i].removal, tier}]};
+      members.push_back(layers[i]);
+      if (members.size() >= std::max<std::size_t>(policy.min_tier_deltas, 2)) {
+        return Compaction{members, false};
+      }
+    }
+    return std::nullopt;
+  }
+
+  auto Compactor::compact_once() -> bool {
+    std::lock_guard compaction_lock{m_compaction_mutex};
+    const auto compaction{plan(m_stack->layers(), m_policy)};
+    if (!compaction) {
+      return false;
+    }
+    std::vector<std::filesystem::path> additions;
+    std::vector<std::filesystem::path> removals;
+    for (const auto& layer: compaction->layers) {
+      // a tier of removals is composed like additions, and the result is removed as a whole.
+      (layer.removal && compaction->major ? removals : additions).push_back(m_stack->layer_path(layer));
+    }
+    auto output{m_stack->new_layer()};
+    output.removal = !compaction->major && compaction->layers.front().removal;
+    DLDI::compose(additions, removals, m_stack->layer_path(output), true, 0, std::thread::hardware_concurrency(), m_throttle.get());
+    m_stack->replace(compaction->layers, output);
+    return true;
+  }
+
+  auto Compactor::notify() -> void {
+    {
+      std::lock_guard lock{m_mutex};
+      m_notified = true;
+    }
+    m_wake.notify_all();
+  }
+
+  auto Compactor::wait_idle() -> void {
+    notify();
+    std::unique_lock lock{m_mutex};
+    m_idle.wait(lock, [this] { return (!m_busy && !m_notified) || m_error; });
+    if (m_error) {
+      std::rethrow_exception(m_error);
+    }
+  }
+
+  auto Compactor::run() -> void {
+    std::unique_lock lock{m_mutex};
+    while (!m_stopping) {
+      m_wake.wait_for(lock, m_policy.poll_interval, [this] { return m_stopping || m_notified; });
+      if (m_stopping) {
+        break;
+      }
+      m_notified = false;
+      m_busy = true;
+      lock.unlock();
+      try {
+        while (compact_once()) {
+          lock.lock();
+          const auto stopping{m_stopping};
+          lock.unlock();
+          if (stopping) {
+            break;
+          }
+        }
+      } catch (...) {
+        lock.lock();
+        m_error = std::current_exception();
+        m_busy = false;
+        m_idle.notify_all();
+        return;
+      }
+      lock.lock();
+      m_busy = false;
+      m_idle.notify_all();
+    }
+  }
+}
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "./ComposeSource.hpp"
+#include "./dictionary/TermEncodingCache.hpp"
+#include "./rdf/ParallelLineParser.hpp"
+
+namespace {
+  /**
+   * Iterates the triples of a writer, which stays locked until the iterator is destroyed.
+  */
+  class VectorTriplesIterator final : public dldi::Iterator<dldi::QuantifiedTriple> {
+  public:
+    VectorTriplesIterator(const dldi::TriplesWriter& triples, std::unique_lock<std::mutex>&& lock)
+      : m_triples{triples},
+        m_lock{std::move(lock)} {
+      update();
+    }
+    auto inner_proceed() -> void override {
+      m_index++;
+      update();
+    }
+
+  private:
+    auto update() -> void {
+      m_has_next = m_index < m_triples.size();
+      if (m_has_next) {
+        m_next = m_triples.triples()[m_index];
+      }
+    }
+    const dldi::TriplesWriter& m_triples;
+    std::unique_lock<std::mutex> m_lock;
+    std::size_t m_index{0};
+  };
+}
+
+namespace dldi {
+  auto ComposeSource::open(const dldi::SourceInfo& info) -> std::shared_ptr<ComposeSource> {
+    if (info.type == dldi::SourceType::DynamicLinkedDataIndex) {
+      return std::make_shared<DLDISource>(info.path);
+    }
+    return std::make_shared<ParsedSource>(info.path);
+  }
+
+  DLDISource::DLDISource(const std::filesystem::path& path)
+    : m_dldi{path} {
+  }
+
+  auto DLDISource::dict(const dldi::TripleTermPosition& position) -> std::shared_ptr<dldi::Dictionary> {
+    m_dldi.ensure_loaded(position);
+    return m_dldi.get_dict(position);
+  }
+
+  auto DLDISource::triples(const dldi::TripleOrder& order) -> std::shared_ptr<dldi::Iterator<dldi::QuantifiedTriple>> {
+    m_dldi.ensure_loaded_triples(order);
+    return m_dldi.query_ptr(order);
+  }
+
+  ParsedSource::ParsedSource(const std::filesystem::path& path, const std::string& base_iri) {
+    for (auto& dict: m_dicts) {
+      dict = std::make_shared<dldi::Dictionary>();
+    }
+    dldi::TermEncodingCache subject_ids{*m_dicts[0]};
+    dldi::TermEncodingCache predicate_ids{*m_dicts[1]};
+    dldi::TermEncodingCache object_ids{*m_dicts[2]};
+    rdf::parse_file(
+      path,
+      [&](const std::string& subject, const std::string& predicate, const std::string& object) {
+        m_triples.add(subject_ids.add(subject), predicate_ids.add(predicate), object_ids.add(object));
+      },
+      base_iri);
+    subject_ids.flush();
+    predicate_ids.flush();
+    object_ids.flush();
+
+    // Like those of a DLDI, the triples use IDs which sort like their terms,
+    // so each order is a plain sort by ID.
+    for (std::size_t i{0}; i < m_dicts.size(); i++) {
+      m_triple_ids[i] = m_dicts[i]->lexicographic_ids();
+    }
+    m_triples.remap(m_triple_ids[0], m_triple_ids[1], m_triple_ids[2]);
+  }
+
+  auto ParsedSource::dict(const dldi::TripleTermPosition& position) -> std::shared_ptr<dldi::Dictionary> {
+    return m_dicts[static_cast<std::size_t>(position)];
+  }
+
+  auto ParsedSource::triples(const dldi::TripleOrder& order) -> std::shared_ptr<dldi::Iterator<dldi::QuantifiedTriple>> {
+    std::unique_lock lock{m_triples_mutex};
+    m_triples.radix_sort(order, std::max<std::size_t>(std::thread::hardware_concurrency(), 1));
+    return std::make_shared<VectorTriplesIterator>(m_triples, std::move(lock));
+  }
+
+  auto ParsedSource::by_triple_ids(dldi::IdMapping table, const dldi::TripleTermPosition& position) const -> dldi::IdMapping {
+    const auto& triple_ids{m_triple_ids[static_cast<std::size_t>(position)]};
+    dldi::IdMapping result(triple_ids.size(), 0);
+    for (std::size_t id{1}; id < triple_ids.size() && id < table.size(); id++) {
+      result.at(triple_ids.at(id)) = table.at(id);
+    }
+    return result;
+  }
+}
@@ -0,0 +1,73 @@
+#ifndef DLDI_COMPOSE_SOURCE_HPP
+#define DLDI_COMPOSE_SOURCE_HPP
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <DLDI.hpp>
+#include <Iterator.hpp>
+
+#include "./triples/TriplesWriter.hpp"
+
+namespace dldi {
+
+  /**
+   * Something to add to or remove from a composition:
+   * three dictionaries, and the triples in each order, sorted like their terms.
+  */
+  class ComposeSource {
+  public:
+    virtual ~ComposeSource() = default;
+    /**
+     * Opens a DLDI, or parses a plaintext linked data file into memory.
+    */
+    static auto open(const dldi::SourceInfo& info) -> std::shared_ptr<ComposeSource>;
+
+    virtual auto dict(const dldi::TripleTermPosition& position) -> std::shared_ptr<dldi::Dictionary> = 0;
+    virtual auto triples(const dldi::TripleOrder& order) -> std::shared_ptr<dldi::Iterator<dldi::QuantifiedTriple>> = 0;
+    /**
+     * Turns a table indexed by the IDs of the dictionary at `position`
+     * into one indexed by the IDs the triples use for those terms.
+    */
+    virtual auto by_triple_ids(dldi::IdMapping table, [[maybe_unused]] const dldi::TripleTermPosition& position) const -> dldi::IdMapping {
+      return table;
+    }
+  };
+
+  class DLDISource final : public ComposeSource {
+  public:
+    DLDISource(const std::filesystem::path& path);
+    auto dict(const dldi::TripleTermPosition& position) -> std::shared_ptr<dldi::Dictionary> override;
+    auto triples(const dldi::TripleOrder& order) -> std::shared_ptr<dldi::Iterator<dldi::QuantifiedTriple>> override;
+
+  private:
+    dldi::DLDI m_dldi;
+  };
+
+  /**
+   * A plaintext linked data file, parsed into memory.
+   * Its triples are kept in a single buffer, which is sorted in place in each order when it is iterated.
+   * The buffer is locked for as long as the iterator lives, so that orders are iterated one at a time;
+   * iterators of several sources must be opened in the same order of sources by every thread.
+  */
+  class ParsedSource final : public ComposeSource {
+  public:
+    ParsedSource(const std::filesystem::path& path, const std::string& base_iri = "https://example.com/");
+    auto dict(const dldi::TripleTermPosition& position) -> std::shared_ptr<dldi::Dictionary> override;
+    auto triples(const dldi::TripleOrder& order) -> std::shared_ptr<dldi::Iterator<dldi::QuantifiedTriple>> override;
+    auto by_triple_ids(dldi::IdMapping table, const dldi::TripleTermPosition& position) const -> dldi::IdMapping override;
+
+  private:
+    std::array<std::shared_ptr<dldi::Dictionary>, 3> m_dicts;
+    /**
+     * The lexicographic IDs of the terms in the dictionaries, which the triples use.
+    */
+    std::array<dldi::IdMapping, 3> m_triple_ids;
+    dldi::TriplesWriter m_triples;
+    std::mutex m_triples_mutex;
+  };
+}
+
+#endif
@@ -1,144 +1,281 @@
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <tuple>
 
-#include "./BinaryStreamWriter.hpp"
+#include "./ComposeSource.hpp"
 #include "./Composer.hpp"
 #include "./triples/TriplesReader.hpp"
-#include "./triples/TriplesWriter.hpp"
+#include "./triples/TriplesStreamWriter.hpp"
 #include <dictionary/Dictionary.hpp>
+#include <dictionary/trie/TrieBuilder.hpp>
 
 namespace {
+  constexpr dldi::TripleTermPosition POSITIONS[]{dldi::TripleTermPosition::subject, dldi::TripleTermPosition::predicate, dldi::TripleTermPosition::object};
+
+  /**
+   * Translations of a source's subject, predicate and object IDs.
+  */
+  using IdMappings = std::array<dldi::IdMapping, 3>;
+
+  inline auto position_index(const dldi::TripleTermPosition& position) -> std::size_t {
+    if (position == dldi::TripleTermPosition::subject)
+      return 0;
+    if (position == dldi::TripleTermPosition::predicate)
+      return 1;
+    if (position == dldi::TripleTermPosition::object)
+      return 2;
+    throw std::runtime_error("Unrecognized position");
+  }
+
+  /**
+   * Add the terms of all sources to the dictionary of the source at `dldi_index`.
+   * Returns, for each source, the translation of its IDs to those of the aggregate dictionary.
+  */
   auto merge_dictionaries(
-    std::vector<std::shared_ptr<dldi::DLDI>>& dldis,
+    std::vector<std::shared_ptr<dldi::ComposeSource>>& sources,
     const dldi::TripleTermPosition& position,
-    const std::size_t& dldi_index) -> void {
-    dldis.at(dldi_index)->ensure_loaded(position);
-    auto aggregate_dict{dldis.at(dldi_index)->get_dict(position)};
-    for (std::size_t i{0}; i < dldis.size(); i++) {
-      if (i == dldi_index)
+    const std::size_t& source_index) -> std::vector<dldi::IdMapping> {
+    auto aggregate_dict{sources.at(source_index)->dict(position)};
+    std::vector<dldi::IdMapping> mappings(sources.size());
+    for (std::size_t i{0}; i < sources.size(); i++) {
+      if (i == source_index)
         continue;
 
-      auto dldi{dldis.at(i)};
-      dldi->ensure_loaded(position);
-      auto terms{dldi->query("", position)};
+      mappings.at(i) = aggregate_dict->merge(*sources.at(i)->dict(position));
+    }
+    // The aggregate dictionary keeps its IDs.
+    const auto num_ids{aggregate_dict->lexicographic_ids().size()};
+    mappings.at(source_index).resize(num_ids);
+    std::iota(mappings.at(source_index).begin(), mappings.at(source_index).end(), 0);
+    return mappings;
+  }
+
+  /**
+   * For each source to remove, the translation of its IDs to those of the aggregate dictionary.
+  */
+  auto removal_ids(
+    std::vector<std::shared_ptr<dldi::ComposeSource>>& removals,
+    const std::vector<std::filesystem::path>& removal_paths,
+    const std::shared_ptr<dldi::Dictionary> aggregate_dict,
+    const dldi::TripleTermPosition& position) -> std::vector<dldi::IdMapping> {
+    std::vector<dldi::IdMapping> mappings(removals.size());
+    for (std::size_t i{0}; i < removals.size(); i++) {
+      auto terms{removals.at(i)->dict(position)->query("")};
       while (terms.has_next()) {
-        const auto term{terms.read()};
-        aggregate_dict->add(term.first, term.second);
+        const auto id{terms.id()};
+        if (mappings.at(i).size() <= id) {
+          mappings.at(i).resize(id + 1, 0);
+        }
+        const auto term{terms.read().first};
+        mappings.at(i).at(id) = aggregate_dict->string_to_id(term);
+        if (mappings.at(i).at(id) == 0) {
+          throw std::runtime_error("Removing a term which none of the additions has: the " +
+                                   dldi::EnumMapping::position_to_string(position) + " `" + term + "` of " + removal_paths.at(i).string());
+        }
         terms.proceed();
       }
     }
+    return mappings;
   }
 
   auto apply_dict_removals(
-    std::shared_ptr<dldi::DLDI> main_dldi,
-    std::vector<std::shared_ptr<dldi::DLDI>>& rem_dldis,
+    std::shared_ptr<dldi::Dictionary> aggregate_dict,
+    std::vector<std::shared_ptr<dldi::ComposeSource>>& removals,
     const dldi::TripleTermPosition& position) -> void {
-    for (const auto& rem_dldi: rem_dldis) {
-      auto terms{rem_dldi->query("", position)};
+    for (const auto& removal: removals) {
+      auto terms{removal->dict(position)->query("")};
       while (terms.has_next()) {
         const auto term{terms.read()};
-        main_dldi->get_dict(position)->remove(term.first, term.second);
+        aggregate_dict->remove(term.first, term.second);
         terms.proceed();
       }
     }
   }
 
-  class DT {
-  public:
-    DT(
+  /**
+   * A source's terms at one position, in lexicographic order, in a k-way merge of dictionaries.
+  */
+  struct TermCursor {
+    csd::TermStringIterator terms;
+    std::size_t source;
+    bool removal;
+    /**
+     * The term and occurrences which `terms` is at.
+    */
+    std::pair<std::string, std::size_t> current;
+  };
 
-      std::shared_ptr<dldi::TriplesIterator> iterator,
-      std::shared_ptr<dldi::Dictionary> subjects,
-      std::shared_ptr<dldi::Dictionary> predicates,
-      std::shared_ptr<dldi::Dictionary> objects)
-      : m_iterator{iterator},
-        m_subjects{subjects},
-        m_predicates{predicates},
-        m_objects{objects} {
-    }
-    auto get_dict(const dldi::TripleTermPosition& position) const -> std::shared_ptr<dldi::Dictionary> {
-      if (position == dldi::TripleTermPosition::subject)
-        return m_subjects;
-      if (position == dldi::TripleTermPosition::predicate)
-        return m_predicates;
-      if (position == dldi::TripleTermPosition::object)
-        return m_objects;
-      throw std::runtime_error("Unrecognized position");
+  inline auto set_rank(dldi::IdMapping& ranks, const std::size_t& id, const std::size_t& rank) -> void {
+    if (ranks.size() <= id) {
+      ranks.resize(id + 1, 0);
     }
-    auto compare(const std::shared_ptr<DT> other, const dldi::TripleTermPosition& position) const -> int {
-      return get_dict(position)->compare(m_iterator->read().term(position), other->m_iterator->read().term(position), other->get_dict(position));
+    ranks.at(id) = rank;
+  }
+
+  /**
+   * Merge the dictionaries at `position` of all sources with a k-way merge of their terms, 
+   * writing the terms which remain after removals to `path` as they come, without building a trie to insert them into. 
+   * Fills in the merge rank of each source's IDs (indexed like the source dictionaries), 
+   * and the ID in the written dictionary of each merge rank, which is 0 for terms which are removed. 
+  */
+  auto stream_dictionaries(
+    std::vector<std::shared_ptr<dldi::ComposeSource>>& additions,
+    std::vector<std::shared_ptr<dldi::ComposeSource>>& removals,
+    const std::vector<std::filesystem::path>& removal_paths,
+    const dldi::TripleTermPosition& position,
+    std::vector<dldi::IdMapping>& addition_ranks,
+    std::vector<dldi::IdMapping>& removal_ranks,
+    dldi::IdMapping& output_ids,
+    const std::filesystem::path& path) -> void {
+    std::vector<TermCursor> cursors;
+    for (const auto removal: {false, true}) {
+      auto& sources{removal ? removals : additions};
+      for (std::size_t i{0}; i < sources.size(); i++) {
+        auto terms{sources.at(i)->dict(position)->query("")};
+        if (terms.has_next()) {
+          auto current{terms.read()};
+          cursors.push_back(TermCursor{std::move(terms), i, removal, std::move(current)});
+        }
+      }
     }
-    auto has_next() const -> bool {
-      return m_iterator->has_next();
+    const auto follows{[&cursors](const std::size_t& lhs, const std::size_t& rhs) {
+      return cursors.at(rhs).current.first < cursors.at(lhs).current.first;
+    }};
+    std::vector<std::size_t> heap(cursors.size());
+    std::iota(heap.begin(), heap.end(), 0);
+    std::make_heap(heap.begin(), heap.end(), follows);
+
+    csd::TrieBuilder builder;
+    output_ids.assign(1, 0);
+    std::string term;
+    while (!heap.empty()) {
+      term = cursors.at(heap.front()).current.first;
+      const auto rank{output_ids.size()};
+      std::size_t added{0};
+      std::size_t removed{0};
+      std::optional<std::size_t> removed_by;
+      while (!heap.empty() && cursors.at(heap.front()).current.first == term) {
+        std::pop_heap(heap.begin(), heap.end(), follows);
+        auto& cursor{cursors.at(heap.back())};
+        if (cursor.removal) {
+          removed += cursor.current.second;
+          removed_by = cursor.source;
+          set_rank(removal_ranks.at(cursor.source), cursor.terms.id(), rank);
+        } else {
+          added += cursor.current.second;
+          set_rank(addition_ranks.at(cursor.source), cursor.terms.id(), rank);
+        }
+        cursor.terms.proceed();
+        if (cursor.terms.has_next()) {
+          cursor.current = cursor.terms.read();
+          std::push_heap(heap.begin(), heap.end(), follows);
+        } else {
+          heap.pop_back();
+        }
+      }
+      if (removed > added) {
+        throw std::runtime_error(
+          (added == 0 ? "Removing a term which none of the additions has: the " : "Removing more occurrences than there are of the ") +
+          dldi::EnumMapping::position_to_string(position) + " `" + term + "` of " + removal_paths.at(*removed_by).string());
+      }
+      output_ids.push_back(0);
+      if (added > removed) {
+        builder.add(term, added - removed);
+        output_ids.back() = builder.numTerms();
+      }
     }
-    auto read() const -> dldi::QuantifiedTriple {
-      return m_iterator->read();
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    if (!out.good()) {
+      throw std::runtime_error("Error opening file to save dictionary: " + path.string());
     }
-    auto proceed() -> void {
-      return m_iterator->proceed();
+    builder.save(out);
+    if (!out.flush()) {
+      throw std::runtime_error("Failed to write " + path.string());
     }
+  }
 
-  private:
-    std::shared_ptr<dldi::TriplesIterator> m_iterator;
-    std::shared_ptr<dldi::Dictionary> m_subjects;
-    std::shared_ptr<dldi::Dictionary> m_predicates;
-    std::shared_ptr<dldi::Dictionary> m_objects;
-  };
+  /**
+   * Chain two translations: `mapping` is changed to map to what `then` maps its values to.
+  */
+  inline auto compose_mapping(dldi::IdMapping& mapping, const dldi::IdMapping& then) -> void {
+    for (auto& id: mapping) {
+      id = then.at(id);
+    }
+  }
 
-  inline auto triple_order_to_position_list(const dldi::TripleOrder& order) -> std::vector<dldi::TripleTermPosition> {
-    if (order == dldi::TripleOrder::SPO)
-      return {dldi::TripleTermPosition::subject, dldi::TripleTermPosition::predicate, dldi::TripleTermPosition::object};
-    if (order == dldi::TripleOrder::SOP)
-      return {dldi::TripleTermPosition::subject, dldi::TripleTermPosition::object, dldi::TripleTermPosition::predicate};
-    if (order == dldi::TripleOrder::POS)
-      return {dldi::TripleTermPosition::predicate, dldi::TripleTermPosition::object, dldi::TripleTermPosition::subject};
-    if (order == dldi::TripleOrder::PSO)
-      return {dldi::TripleTermPosition::predicate, dldi::TripleTermPosition::subject, dldi::TripleTermPosition::object};
-    if (order == dldi::TripleOrder::OSP)
-      return {dldi::TripleTermPosition::object, dldi::TripleTermPosition::subject, dldi::TripleTermPosition::predicate};
-    throw std::runtime_error("Unrecognized order");
+  inline auto translated(const dldi::QuantifiedTriple& triple, const IdMappings& mappings) -> dldi::QuantifiedTriple {
+    const dldi::QuantifiedTriple result{mappings[0].at(triple.subject()), mappings[1].at(triple.predicate()), mappings[2].at(triple.object()), triple.quantity()};
+    if (result.subject() == 0 || result.predicate() == 0 || result.object() == 0) {
+      throw std::runtime_error("Triple refers to a term which is not in the dictionary");
+    }
+    return result;
   }
 
-  class IdTriplesIteratorComparator {
+  /**
+   * A source of triples in a k-way merge,
+   * which translates its triples to merge ranks (IDs which sort like their terms, across all sources).
+  */
+  class DT {
   public:
-    IdTriplesIteratorComparator(const dldi::TripleOrder& order)
-      : m_order{order}, m_positions{triple_order_to_position_list(m_order)} {
+    DT(std::shared_ptr<dldi::Iterator<dldi::QuantifiedTriple>> iterator, const IdMappings& ranks, const dldi::TripleOrder& order)
+      : m_iterator{iterator},
+        m_ranks{&ranks},
+        m_order{order} {
+      update();
     }
-
-    [[nodiscard]] auto operator()(const std::shared_ptr<DT> lhs, const std::shared_ptr<DT> rhs) -> bool {
-      // true: lhs should preceede rhs
-      // false: rhs should preceede lhs
-
-      if (lhs->has_next() && !rhs->has_next())
-        return true;
-      if (!lhs->has_next() && rhs->has_next())
-        return false;
-      if (!lhs->has_next() && !rhs->has_next())
-        return true;
-      // neither is depleted, check which's iterator is lexicographically first. 
-
-      for (const auto position: m_positions) {
-        const auto comparison{lhs->compare(rhs, position)};
-        if (comparison != 0)
-          return comparison < 0;
-      }
-      return true;
-      throw std::runtime_error("Unrecognized order");
+    /**
+     * The ranks of the next triple, in the merge order.
+    */
+    auto key() const -> const std::tuple<std::size_t, std::size_t, std::size_t>& {
+      return m_key;
+    }
+    auto has_next() const -> bool {
+      return m_iterator->has_next();
+    }
+    auto read() const -> const dldi::QuantifiedTriple& {
+      return m_next;
+    }
+    auto proceed() -> void {
+      m_iterator->proceed();
+      update();
     }
 
   private:
+    auto update() -> void {
+      if (!has_next()) {
+        return;
+      }
+      m_next = translated(m_iterator->read(), *m_ranks);
+      m_key = m_next.key(m_order);
+    }
+    std::shared_ptr<dldi::Iterator<dldi::QuantifiedTriple>> m_iterator;
+    const IdMappings* m_ranks;
     const dldi::TripleOrder m_order;
-    const std::vector<dldi::TripleTermPosition> m_positions;
+    dldi::QuantifiedTriple m_next;
+    std::tuple<std::size_t, std::size_t, std::size_t> m_key;
   };
 
-  inline auto largest_dict_index(std::vector<std::shared_ptr<dldi::DLDI>>& dldis, const dldi::TripleTermPosition& position) -> std::size_t {
+  /**
+   * Orders sources for a min-heap on their next triple.
+  */
+  inline auto follows(const std::shared_ptr<DT>& lhs, const std::shared_ptr<DT>& rhs) -> bool {
+    return rhs->key() < lhs->key();
+  }
+
+  inline auto largest_dict_index(std::vector<std::shared_ptr<dldi::ComposeSource>>& sources, const dldi::TripleTermPosition& position) -> std::size_t {
     std::size_t largest{0};
     std::size_t index_of_largest{0};
-    for (std::size_t i{0}; i < dldis.size(); i++) {
-      auto dldi{dldis.at(i)};
-      dldi->ensure_loaded(position);
-      auto dict{dldi->get_dict(position)};
-      const auto size{dict->size()};
+    for (std::size_t i{0}; i < sources.size(); i++) {
+      const auto size{sources.at(i)->dict(position)->size()};
       if (size > largest) {
         largest = size;
         index_of_largest = i;
@@ -147,36 +284,25 @@ namespace {
     return index_of_largest;
   }
 
+  /**
+   * Merges the triples of several sources in the given order,
+   * translated to merge ranks with the given per-source mappings.
+  */
   class RemappedAggregateTriplesIterator : public dldi::Iterator<dldi::QuantifiedTriple> {
   public:
     RemappedAggregateTriplesIterator(
-      std::vector<std::shared_ptr<dldi::DLDI>>& dldis,
-      const std::shared_ptr<dldi::Dictionary> mapto_subjects_dict,
-      const std::shared_ptr<dldi::Dictionary> mapto_predicates_dict,
-      const std::shared_ptr<dldi::Dictionary> mapto_objects_dict,
-      const dldi::TripleOrder& order)
-      : m_dldis{dldis},
-        m_mapto_subjects_dict{mapto_subjects_dict},
-        m_mapto_predicates_dict{mapto_predicates_dict},
-        m_mapto_objects_dict{mapto_objects_dict},
-        m_order{order},
-        m_comparator{IdTriplesIteratorComparator{order}} {
-      for (auto dldi: dldis) {
-        dldi->ensure_loaded_triples(order);
-        dldi->ensure_loaded(dldi::TripleTermPosition::subject);
-        dldi->ensure_loaded(dldi::TripleTermPosition::predicate);
-        dldi->ensure_loaded(dldi::TripleTermPosition::object);
-        auto query_iterator{dldi->query_ptr(order)};
-
-        m_dts.push_back(
-          std::make_shared<DT>(
-            query_iterator,
-            dldi->get_dict(dldi::TripleTermPosition::subject),
-            dldi->get_dict(dldi::TripleTermPosition::predicate),
-            dldi->get_dict(dldi::TripleTermPosition::object)));
+      std::vector<std::shared_ptr<dldi::ComposeSource>>& sources,
+      const std::vector<IdMappings>& ranks,
+      const dldi::TripleOrder& order) {
+      for (std::size_t i{0}; i < sources.size(); i++) {
+        auto query_iterator{sources.at(i)->triples(order)};
+        if (!query_iterator->has_next()) {
+          continue;
+        }
+        m_heap.push_back(std::make_shared<DT>(query_iterator, ranks.at(i), order));
       }
-      std::sort(m_dts.begin(), m_dts.end(), m_comparator);
-      m_has_next = !dldis.empty();
+      std::make_heap(m_heap.begin(), m_heap.end(), follows);
+      m_has_next = !m_heap.empty();
       if (has_next()) {
         proceed();
       }
@@ -184,61 +310,94 @@ namespace {
 
   protected:
     auto inner_proceed() -> void override {
-      if (m_dts.empty()) {
+      if (m_heap.empty()) {
         m_has_next = false;
         return;
       }
       m_has_next = true;
-      auto dt{m_dts.at(0)};
-      auto id_next{dt->read()};
-
-      const dldi::QuantifiedTriple id_final{
-        dt->get_dict(dldi::TripleTermPosition::subject) == m_mapto_subjects_dict ? id_next.subject() : (m_mapto_subjects_dict->string_to_id(dt->get_dict(dldi::TripleTermPosition::subject)->id_to_string(id_next.subject()))),
-        dt->get_dict(dldi::TripleTermPosition::predicate) == m_mapto_predicates_dict ? id_next.predicate() : (m_mapto_predicates_dict->string_to_id(dt->get_dict(dldi::TripleTermPosition::predicate)->id_to_string(id_next.predicate()))),
-        dt->get_dict(dldi::TripleTermPosition::object) == m_mapto_objects_dict ? id_next.object() : (m_mapto_objects_dict->string_to_id(dt->get_dict(dldi::TripleTermPosition::object)->id_to_string(id_next.object()))),
-        id_next.quantity()};
-
-      m_next = id_final;
+      auto dt{m_heap.front()};
+      m_next = dt->read();
 
       dt->proceed();
       if (!dt->has_next()) {
-        m_dts.erase(m_dts.begin());
+        std::pop_heap(m_heap.begin(), m_heap.end(), follows);
+        m_heap.pop_back();
       } else {
-        std::sort(m_dts.begin(), m_dts.end(), m_comparator);
+        sift_down_front();
       }
     }
 
   private:
-    std::vector<std::shared_ptr<dldi::DLDI>>& m_dldis;
-    const std::shared_ptr<dldi::Dictionary> m_mapto_subjects_dict;
-    const std::shared_ptr<dldi::Dictionary> m_mapto_predicates_dict;
-    const std::shared_ptr<dldi::Dictionary> m_mapto_objects_dict;
-    std::vector<std::shared_ptr<DT>> m_dts;
-    IdTriplesIteratorComparator m_comparator;
-    const dldi::TripleOrder& m_order;
+    /**
+     * Restore the heap after the front source has proceeded, with a single sift.
+    */
+    auto sift_down_front() -> void {
+      std::size_t i{0};
+      while (true) {
+        const auto left{2 * i + 1};
+        if (left >= m_heap.size()) {
+          return;
+        }
+        const auto right{left + 1};
+        const auto smallest{right < m_heap.size() && follows(m_heap[left], m_heap[right]) ? right : left};
+        if (!follows(m_heap[i], m_heap[smallest])) {
+          return;
+        }
+        std::swap(m_heap[i], m_heap[smallest]);
+        i = smallest;
+      }
+    }
+    /**
+     * The sources which aren't depleted, as a min-heap on their next triple.
+    */
+    std::vector<std::shared_ptr<DT>> m_heap;
   };
 
+  /**
+   * Run independent tasks on up to `num_threads` threads. 
+   * Rethrows the first exception of a failed task once all threads are done. 
+  */
+  inline auto run_parallel(const std::vector<std::function<void()>>& tasks, const std::size_t& num_threads) -> void {
+    std::atomic<std::size_t> next_task{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    std::vector<std::thread> threads;
+    const auto thread_count{std::clamp<std::size_t>(num_threads, 1, tasks.size())};
+    for (std::size_t i{0}; i < thread_count; i++) {
+      threads.emplace_back([&]() {
+        for (auto task{next_task++}; task < tasks.size(); task = next_task++) {
+          try {
+            tasks.at(task)();
+          } catch (...) {
+            std::lock_guard lock{error_mutex};
+            if (!error) {
+              error = std::current_exception();
+            }
+          }
+        }
+      });
+    }
+    for (auto& thread: threads) {
+      thread.join();
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
   auto merge_triples(
-    std::vector<std::shared_ptr<dldi::DLDI>>& additions,
-    std::vector<std::shared_ptr<dldi::DLDI>>& removals,
+    std::vector<std::shared_ptr<dldi::ComposeSource>>& additions,
+    std::vector<std::shared_ptr<dldi::ComposeSource>>& removals,
+    const std::vector<IdMappings>& addition_ranks,
+    const std::vector<IdMappings>& removal_ranks,
+    const IdMappings& output_ids,
     const std::filesystem::path& output_path,
-    const std::size_t& largest_subject_index,
-    const std::size_t& largest_predicate_index,
-    const std::size_t& largest_object_index,
-    const dldi::TripleOrder& order) -> void {
-    RemappedAggregateTriplesIterator add_iterator{
-      additions,
-      additions.at(largest_subject_index)->get_dict(dldi::TripleTermPosition::subject),
-      additions.at(largest_predicate_index)->get_dict(dldi::TripleTermPosition::predicate),
-      additions.at(largest_object_index)->get_dict(dldi::TripleTermPosition::object),
-      order};
-    RemappedAggregateTriplesIterator rem_iterator{
-      removals,
-      additions.at(largest_subject_index)->get_dict(dldi::TripleTermPosition::subject),
-      additions.at(largest_predicate_index)->get_dict(dldi::TripleTermPosition::predicate),
-      additions.at(largest_object_index)->get_dict(dldi::TripleTermPosition::object),
-      order};
-    dldi::StreamWriter<dldi::QuantifiedTriple> triples{dldi::TriplesReader::triples_file_path(output_path, order)};
+    const dldi::TripleOrder& order,
+    dldi::WriteThrottle* throttle,
+    dldi::StatisticsCollector* statistics) -> void {
+    RemappedAggregateTriplesIterator add_iterator{additions, addition_ranks, order};
+    RemappedAggregateTriplesIterator rem_iterator{removals, removal_ranks, order};
+    dldi::TriplesStreamWriter triples{dldi::TriplesReader::triples_file_path(output_path, order), order, throttle, statistics};
     while (add_iterator.has_next()) {
       auto add_next{add_iterator.read()};
 
@@ -255,7 +414,7 @@ namespace {
         rem_iterator.proceed();
       }
       if (add_next.quantity() > 0) {
-        triples.write(add_next);
+        triples.write(translated(add_next, output_ids));
       }
     }
     if (rem_iterator.has_next()) {
@@ -264,52 +423,103 @@ namespace {
       std::cout << std::endl;
       throw std::runtime_error("Rem iterator not depleted");
     }
+    triples.close();
   }
 }
 namespace dldi {
-  auto Composer::zip(dldi::SourceInfoVector& additions, dldi::SourceInfoVector& removals, const std::filesystem::path& output_dir) -> void {
-    bool all_dldis{true};
-    for (const auto source: additions) {
-      if (source.type != dldi::SourceType::DynamicLinkedDataIndex) {
-        all_dldis = false;
-        break;
-      }
+  auto Composer::zip(dldi::SourceInfoVector& additions, dldi::SourceInfoVector& removals, const std::filesystem::path& output_dir, bool order_preserving_ids, const std::size_t& num_threads) -> void {
+    // Plaintext sources are parsed into memory, and join the merge like DLDIs do.
+    std::vector<std::shared_ptr<dldi::ComposeSource>> add_sources;
+    std::vector<std::shared_ptr<dldi::ComposeSource>> rem_sources;
+    for (const auto& source: additions) {
+      add_sources.push_back(dldi::ComposeSource::open(source));
     }
-
-    if (!all_dldis) {
-      throw std::runtime_error("This combination of sources is not yet supported");
+    for (const auto& source: removals) {
+      rem_sources.push_back(dldi::ComposeSource::open(source));
     }
 
-    std::vector<std::shared_ptr<dldi::DLDI>> add_dldis;
-    std::vector<std::shared_ptr<dldi::DLDI>> rem_dldis;
-
-    for (const auto source: additions) {
-      add_dldis.push_back(std::make_shared<dldi::DLDI>(dldi::DLDI{source.path}));
-    }
-    for (const auto source: removals) {
-      rem_dldis.push_back(std::make_shared<dldi::DLDI>(dldi::DLDI{source.path}));
+    // Each source's IDs are translated to merge ranks, which sort like their terms across all sources,
+    // so that merging triples needs no dictionary lookups.
+    // The tables are built once, and used for all orders.
+    std::vector<IdMappings> addition_ranks(add_sources.size());
+    std::vector<IdMappings> removal_ranks(rem_sources.size());
+    IdMappings output_ids;
+    std::array<std::shared_ptr<dldi::Dictionary>, 3> dicts;
+    std::vector<std::filesystem::path> removal_paths;
+    for (const auto& source: removals) {
+      removal_paths.push_back(source.path);
     }
+    // The positions, and then the orders, are independent of each other, so they are merged in parallel.
+    std::vector<std::function<void()>> dictionary_merges;
+    for (const auto position: POSITIONS) {
+      dictionary_merges.push_back([&, position]() {
+        const auto p{position_index(position)};
+        if (order_preserving_ids) {
+          // All IDs are reassigned, so the dictionary is written from scratch as the merge goes.
+          std::vector<dldi::IdMapping> add_ranks(add_sources.size());
+          std::vector<dldi::IdMapping> rem_ranks(rem_sources.size());
+          const auto path{dldi::Dictionary::dictionary_file_path(output_dir, position)};
+          stream_dictionaries(add_sources, rem_sources, removal_paths, position, add_ranks, rem_ranks, output_ids[p], path);
+          if (m_throttle != nullptr) {
+            m_throttle->wrote(std::filesystem::file_size(path));
+          }
+          for (std::size_t i{0}; i < add_sources.size(); i++) {
+            addition_ranks.at(i)[p] = add_sources.at(i)->by_triple_ids(std::move(add_ranks.at(i)), position);
+          }
+          for (std::size_t i{0}; i < rem_sources.size(); i++) {
+            removal_ranks.at(i)[p] = rem_sources.at(i)->by_triple_ids(std::move(rem_ranks.at(i)), position);
+          }
+          return;
+        }
+        // Otherwise, the terms of all sources are added to the largest dictionary, which keeps its IDs.
+        const auto largest_index{largest_dict_index(add_sources, position)};
+        dicts[p] = add_sources.at(largest_index)->dict(position);
 
-    const auto largest_subject_index{largest_dict_index(add_dldis, dldi::TripleTermPosition::subject)};
-    const auto largest_predicate_index{largest_dict_index(add_dldis, dldi::TripleTermPosition::predicate)};
-    const auto largest_object_index{largest_dict_index(add_dldis, dldi::TripleTermPosition::object)};
+        auto aggregate_ids{merge_dictionaries(add_sources, position, largest_index)};
+        auto rem_aggregate_ids{removal_ids(rem_sources, removal_paths, dicts[p], position)};
+        const auto ranks{dicts[p]->lexicographic_ids()};
+        for (std::size_t i{0}; i < add_sources.size(); i++) {
+          compose_mapping(aggregate_ids.at(i), ranks);
+          addition_ranks.at(i)[p] = add_sources.at(i)->by_triple_ids(std::move(aggregate_ids.at(i)), position);
+        }
+        for (std::size_t i{0}; i < rem_sources.size(); i++) {
+          compose_mapping(rem_aggregate_ids.at(i), ranks);
+          removal_ranks.at(i)[p] = rem_sources.at(i)->by_triple_ids(std::move(rem_aggregate_ids.at(i)), position);
+        }
 
-    merge_dictionaries(add_dldis, dldi::TripleTermPosition::subject, largest_subject_index);
-    merge_dictionaries(add_dldis, dldi::TripleTermPosition::predicate, largest_predicate_index);
-    merge_dictionaries(add_dldis, dldi::TripleTermPosition::object, largest_object_index);
+        apply_dict_removals(dicts[p], rem_sources, position);
 
-    for (auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
-      merge_triples(add_dldis, rem_dldis, output_dir, largest_subject_index, largest_predicate_index, largest_object_index, order);
+        // Merged triples are translated from merge ranks to the IDs of the saved dictionary.
+        const auto num_ranks{static_cast<std::size_t>(std::ranges::count_if(ranks, [](const std::size_t& rank) { return rank != 0; }))};
+        output_ids[p].resize(num_ranks + 1, 0);
+        for (std::size_t id{1}; id < ranks.size(); id++) {
+          if (ranks.at(id) != 0) {
+            output_ids[p].at(ranks.at(id)) = id;
+          }
+        }
+      });
     }
+    run_parallel(dictionary_merges, num_threads);
 
-    if (!rem_dldis.empty()) {
-      apply_dict_removals(add_dldis.at(largest_subject_index), rem_dldis, dldi::TripleTermPosition::subject);
-      apply_dict_removals(add_dldis.at(largest_predicate_index), rem_dldis, dldi::TripleTermPosition::predicate);
-      apply_dict_removals(add_dldis.at(largest_object_index), rem_dldis, dldi::TripleTermPosition::object);
+    // The statistics are counted while the orders are written, rather than read back from them.
+    dldi::StatisticsCollector statistics;
+    std::vector<std::function<void()>> triple_merges;
+    for (auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
+      triple_merges.push_back([&, order]() {
+        merge_triples(add_sources, rem_sources, addition_ranks, removal_ranks, output_ids, output_dir, order, m_throttle, &statistics);
+      });
     }
+    run_parallel(triple_merges, num_threads);
 
-    add_dldis.at(largest_subject_index)->get_dict(dldi::TripleTermPosition::subject)->save(dldi::Dictionary::dictionary_file_path(output_dir, dldi::TripleTermPosition::subject));
-    add_dldis.at(largest_predicate_index)->get_dict(dldi::TripleTermPosition::predicate)->save(dldi::Dictionary::dictionary_file_path(output_dir, dldi::TripleTermPosition::predicate));
-    add_dldis.at(largest_object_index)->get_dict(dldi::TripleTermPosition::object)->save(dldi::Dictionary::dictionary_file_path(output_dir, dldi::TripleTermPosition::object));
+    if (!order_preserving_ids) {
+      for (const auto position: POSITIONS) {
+        const auto path{dldi::Dictionary::dictionary_file_path(output_dir, position)};
+        dicts[position_index(position)]->save(path, false);
+        if (m_throttle != nullptr) {
+          m_throttle->wrote(std::filesystem::file_size(path));
+        }
+      }
+    }
+    statistics.finish(output_dir).save(dldi::Statistics::statistics_file_path(output_dir));
   }
 }
@@ -1,7 +1,10 @@
 #ifndef ZIPPER_HPP
 #define ZIPPER_HPP
 
+#include <thread>
+
 #include <DLDI.hpp>
+#include <WriteThrottle.hpp>
 
 namespace dldi {
 
@@ -9,19 +12,37 @@ namespace dldi {
 
   class Composer {
   public:
-    Composer() = default;
+    /**
+     * With a throttle, the files of the result are written no faster than it allows.
+    */
+    explicit Composer(WriteThrottle* throttle = nullptr)
+      : m_throttle{throttle} {
+    }
 
     /**
      * Takes a set of sources which should be added or subtracted, 
      * and writes a result DLDI to the specified output dir. 
+     * Sources may be DLDIs or plaintext linked data files, which are parsed into memory. 
      * 
      * For the procedure to succeed, the following must hold: 
      *  - The number of subtractions of a triple or a term 
      *    must not exceed its number of additions.   
+     * 
+     * With order-preserving IDs, each dictionary is written as a k-way merge of the sources' terms goes, 
+     * so that no source dictionary is extended in memory. 
+     * Without them, the result keeps the IDs of the largest source dictionaries, which the other terms are added to. 
+     * 
+     * The three dictionaries, and then the five triple orders, are merged on up to `num_threads` threads. 
+     * The statistics of the result are saved along with it. 
     */
-    auto zip(SourceInfoVector& additions, SourceInfoVector& removals, const std::filesystem::path& output_dir) -> void;
+    auto zip(SourceInfoVector& additions,
+             SourceInfoVector& removals,
+             const std::filesystem::path& output_dir,
+             bool order_preserving_ids = true,
+             const std::size_t& num_threads = std::thread::hardware_concurrency()) -> void;
 
   private:
+    WriteThrottle* m_throttle;
     // auto merge_dictionary(const dldi::TripleTermPosition& position, SourceInfoVector& additions, SourceInfoVector& removals) -> void;
   };
 }
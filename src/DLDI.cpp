@@ -46,6 +46,16 @@ namespace dldi {
     return triples->query_ptr(dldi::TriplePattern{0, 0, 0}, *m_subjects, *m_predicates, *m_objects);
   }
 
+  auto DLDI::count(const dldi::TriplePattern& pattern) const -> std::size_t {
+    const auto order{decide_order_from_triple_pattern(pattern)};
+    const auto triples{get_triples(order)};
+    if (triples == nullptr) {
+      throw std::runtime_error("Triples not loaded!");
+    }
+    const auto [begin, end]{triples->range(pattern, *m_subjects, *m_predicates, *m_objects)};
+    return end - begin;
+  }
+
   auto DLDI::query(const std::string prefix, const dldi::TripleTermPosition position) const -> csd::TermStringIterator {
     const auto dict{
       position == dldi::TripleTermPosition::subject ? m_subjects : position == dldi::TripleTermPosition::predicate ? m_predicates :
@@ -90,6 +100,20 @@ namespace dldi {
     }
     return dict->id_to_string(id);
   }
+  auto DLDI::append_string(const std::size_t& id, const dldi::TripleTermPosition& position, std::string& buffer) const -> void {
+    const auto dict{get_dict(position)};
+    if (!dict){
+      throw std::runtime_error("Dict isn't loaded");
+    }
+    dict->append_string(id, buffer);
+  }
+  auto DLDI::decode(std::span<const std::size_t> ids, const dldi::TripleTermPosition& position, std::string& buffer, std::vector<std::string_view>& terms) const -> void {
+    const auto dict{get_dict(position)};
+    if (!dict){
+      throw std::runtime_error("Dict isn't loaded");
+    }
+    dict->decode(ids, buffer, terms);
+  }
   auto DLDI::ensure_loaded(const dldi::TripleTermPosition& position) -> void {
     if (get_dict(position)) {
       return;
@@ -108,6 +132,21 @@ namespace dldi {
     }
   }
 
+  auto DLDI::ensure_loaded_statistics() -> void {
+    if (m_statistics) {
+      return;
+    }
+    const auto path{dldi::Statistics::statistics_file_path(m_datadir)};
+    m_statistics = std::make_shared<Statistics>(std::filesystem::exists(path) ? Statistics::load(path) : Statistics::compute(m_datadir));
+  }
+
+  auto DLDI::statistics() const -> const dldi::Statistics& {
+    if (!m_statistics) {
+      throw std::runtime_error("Statistics not loaded!");
+    }
+    return *m_statistics;
+  }
+
   auto DLDI::prepare_for_query(const dldi::TriplePattern& pattern) -> void {
     const auto order{decide_order_from_triple_pattern(pattern)};
     ensure_loaded_triples(order);
@@ -0,0 +1,436 @@
+#include <algorithm>
+#include <optional>
+#include <tuple>
+
+#include <DLDIView.hpp>
+
+namespace dldi {
+  constexpr dldi::TripleTermPosition POSITIONS[]{dldi::TripleTermPosition::subject, dldi::TripleTermPosition::predicate, dldi::TripleTermPosition::object};
+
+  inline auto position_index(const dldi::TripleTermPosition& position) -> std::size_t {
+    return position == dldi::TripleTermPosition::subject ? 0 : position == dldi::TripleTermPosition::predicate ? 1 :
+                                                                                                                 2;
+  }
+
+  ViewLayers::ViewLayers(const std::filesystem::path& base, const std::vector<ViewDelta>& deltas, std::shared_ptr<const void> lease)
+    : m_lease{std::move(lease)},
+      m_base{std::make_shared<DLDI>(base)} {
+    for (const auto& delta: deltas) {
+      m_deltas.push_back(std::make_shared<DLDI>(delta.path));
+      m_removals.push_back(delta.removal);
+    }
+  }
+
+  auto ViewLayers::terms(const dldi::TripleTermPosition& position) const -> const Terms& {
+    const auto& result{m_terms[position_index(position)]};
+    if (!result.loaded) {
+      throw std::runtime_error("Dict isn't loaded");
+    }
+    return result;
+  }
+
+  auto ViewLayers::ensure_loaded(const dldi::TripleTermPosition& position) -> void {
+    std::lock_guard lock{m_mutex};
+    auto& terms{m_terms[position_index(position)]};
+    if (terms.loaded) {
+      return;
+    }
+    m_base->ensure_loaded(position);
+    const auto base_dict{m_base->get_dict(position)};
+    // with IDs which aren't order-preserving, removals leave gaps, so the size of the base isn't its largest ID.
+    terms.base_max_id = base_dict->max_id();
+    terms.max_id = terms.base_max_id;
+
+    // the deltas are expected to be small, so their terms are all visited once here.
+    for (std::size_t i{0}; i < m_deltas.size(); i++) {
+      m_deltas[i]->ensure_loaded(position);
+      const auto delta_dict{m_deltas[i]->get_dict(position)};
+      terms.delta_offsets.push_back(terms.max_id - terms.base_max_id);
+      dldi::IdMapping ids(delta_dict->max_id() + 1, 0);
+      auto it{delta_dict->query("")};
+      while (it.has_next()) {
+        const auto term{it.read().first};
+        auto id{base_dict->string_to_id(term)};
+        for (std::size_t j{0}; id == 0 && j < i; j++) {
+          const auto delta_id{m_deltas[j]->string_to_id(term, position)};
+          id = delta_id == 0 ? 0 : terms.delta_ids[j][delta_id];
+        }
+        ids[it.id()] = id != 0 ? id : terms.max_id + it.id();
+        it.proceed();
+      }
+      terms.delta_ids.push_back(std::move(ids));
+      terms.max_id += delta_dict->max_id();
+    }
+    terms.loaded = true;
+  }
+
+  auto ViewLayers::ensure_loaded_triples(const dldi::TripleOrder& order) -> void {
+    for (const auto position: POSITIONS) {
+      ensure_loaded(position);
+    }
+    std::lock_guard lock{m_mutex};
+    if (m_loaded_orders.contains(order)) {
+      return;
+    }
+    m_base->ensure_loaded_triples(order);
+    for (const auto& delta: m_deltas) {
+      delta->ensure_loaded_triples(order);
+    }
+    m_loaded_orders.insert(order);
+  }
+
+  auto ViewLayers::string_to_id(const std::string& term, const dldi::TripleTermPosition& position) const -> std::size_t {
+    const auto& layer_terms{terms(position)};
+    const auto base_id{m_base->string_to_id(term, position)};
+    if (base_id != 0) {
+      return base_id;
+    }
+    for (std::size_t i{0}; i < m_deltas.size(); i++) {
+      const auto delta_id{m_deltas[i]->string_to_id(term, position)};
+      if (delta_id != 0) {
+        return layer_terms.delta_ids[i][delta_id];
+      }
+    }
+    return 0;
+  }
+
+  auto ViewLayers::id_to_string(const std::size_t& id, const dldi::TripleTermPosition& position) const -> std::string {
+    const auto& layer_terms{terms(position)};
+    if (id <= layer_terms.base_max_id) {
+      return m_base->id_to_string(id, position);
+    }
+    // the delta whose range of IDs holds `id` is the last one starting below it.
+    const auto offset{id - layer_terms.base_max_id};
+    const auto delta{std::upper_bound(layer_terms.delta_offsets.begin(), layer_terms.delta_offsets.end(), offset - 1) - layer_terms.delta_offsets.begin() - 1};
+    return m_deltas.at(static_cast<std::size_t>(delta))->id_to_string(offset - layer_terms.delta_offsets[static_cast<std::size_t>(delta)], position);
+  }
+
+  DLDIView::DLDIView(const std::filesystem::path& base, const std::vector<ViewDelta>& deltas, dldi::BufferedChanges buffer, std::shared_ptr<const void> lease)
+    : DLDIView{std::make_shared<ViewLayers>(base, deltas, std::move(lease)), std::move(buffer)} {
+  }
+
+  DLDIView::DLDIView(std::shared_ptr<ViewLayers> layers, dldi::BufferedChanges buffer)
+    : m_layers{std::move(layers)},
+      m_buffer{std::move(buffer)} {
+  }
+
+  auto DLDIView::terms(const dldi::TripleTermPosition& position) const -> const BufferedTerms& {
+    const auto& result{m_terms[position_index(position)]};
+    if (!result.loaded) {
+      throw std::runtime_error("Dict isn't loaded");
+    }
+    return result;
+  }
+
+  auto DLDIView::ensure_loaded(const dldi::TripleTermPosition& position) -> void {
+    auto& terms{m_terms[position_index(position)]};
+    if (terms.loaded) {
+      return;
+    }
+    m_layers->ensure_loaded(position);
+    // every statement counts as an occurrence of each of its terms.
+    std::map<std::string, std::int64_t> changes;
+    for (const auto& [triple, quantity]: m_buffer) {
+      const std::array<const std::string*, 3> triple_terms{&std::get<0>(triple), &std::get<1>(triple), &std::get<2>(triple)};
+      changes[*triple_terms[position_index(position)]] += quantity;
+    }
+    const auto max_id{m_layers->terms(position).max_id};
+    for (const auto& [term, change]: changes) {
+      if (m_layers->string_to_id(term, position) == 0) {
+        terms.new_ids.emplace(term, max_id + terms.new_terms.size() + 1);
+        terms.new_terms.push_back(term);
+      }
+      terms.changes.emplace_back(term, change);
+    }
+    terms.loaded = true;
+  }
+
+  auto DLDIView::ensure_loaded_triples(const dldi::TripleOrder& order) -> void {
+    if (m_changes.contains(order)) {
+      return;
+    }
+    m_layers->ensure_loaded_triples(order);
+    for (const auto position: POSITIONS) {
+      ensure_loaded(position);
+    }
+    std::vector<TripleChange> changes;
+    for (const auto& [triple, quantity]: m_buffer) {
+      if (quantity != 0) {
+        const auto& [subject, predicate, object]{triple};
+        changes.push_back(TripleChange{QuantifiedTriple{string_to_id(subject, dldi::TripleTermPosition::subject),
+                                                        string_to_id(predicate, dldi::TripleTermPosition::predicate),
+                                                        string_to_id(object, dldi::TripleTermPosition::object), 0},
+                                       quantity});
+      }
+    }
+    std::sort(changes.begin(), changes.end(), [this, &order](const TripleChange& lhs, const TripleChange& rhs) {
+      return compare(lhs.triple, rhs.triple, order) < 0;
+    });
+    m_changes.emplace(order, std::move(changes));
+  }
+
+  auto DLDIView::prepare_for_query(const dldi::TriplePattern& pattern) -> void {
+    ensure_loaded_triples(DLDI::decide_order_from_triple_pattern(pattern));
+  }
+
+  auto DLDIView::string_to_id(const std::string& term, const dldi::TripleTermPosition& position) const -> std::size_t {
+    const auto& view_terms{terms(position)};
+    const auto layer_id{m_layers->string_to_id(term, position)};
+    if (layer_id != 0) {
+      return layer_id;
+    }
+    const auto it{view_terms.new_ids.find(term)};
+    return it == view_terms.new_ids.end() ? 0 : it->second;
+  }
+
+  auto DLDIView::id_to_string(const std::size_t& id, const dldi::TripleTermPosition& position) const -> std::string {
+    const auto& view_terms{terms(position)};
+    const auto max_id{m_layers->terms(position).max_id};
+    if (id <= max_id) {
+      return m_layers->id_to_string(id, position);
+    }
+    return view_terms.new_terms.at(id - max_id - 1);
+  }
+
+  auto DLDIView::compare(const std::size_t& lhs, const std::size_t& rhs, const dldi::TripleTermPosition& position) const -> int {
+    if (lhs == rhs) {
+      return 0;
+    }
+    const auto base_max_id{m_layers->terms(position).base_max_id};
+    if (lhs <= base_max_id && rhs <= base_max_id) {
+      return m_layers->m_base->get_dict(position)->compare(lhs, rhs);
+    }
+    const auto comparison{id_to_string(lhs, position).compare(id_to_string(rhs, position))};
+    return comparison < 0 ? -1 : comparison > 0 ? 1 :
+                                                  0;
+  }
+
+  auto DLDIView::compare(const QuantifiedTriple& lhs, const QuantifiedTriple& rhs, const dldi::TripleOrder& order) const -> int {
+    for (const auto position: QuantifiedTriple::key_positions(order)) {
+      const auto comparison{compare(lhs.term(position), rhs.term(position), position)};
+      if (comparison != 0) {
+        return comparison;
+      }
+    }
+    return 0;
+  }
+
+  auto DLDIView::query_ptr(const dldi::TriplePattern& pattern) const -> std::shared_ptr<dldi::ViewTriplesIterator> {
+    const auto order{DLDI::decide_order_from_triple_pattern(pattern)};
+    const auto changes{m_changes.find(order)};
+    if (changes == m_changes.end()) {
+      throw std::runtime_error("Triples not loaded!");
+    }
+    const auto [s, p, o]{pattern};
+    const QuantifiedTriple key{s, p, o, 0};
+    // the bound positions of a pattern come first in its order, so its matches are a range of the sorted changes.
+    const auto compare_bound{[this, &key, &order](const TripleChange& change) {
+      for (const auto position: QuantifiedTriple::key_positions(order)) {
+        if (key.term(position) == 0) {
+          break;
+        }
+        const auto comparison{compare(change.triple.term(position), key.term(position), position)};
+        if (comparison != 0) {
+          return comparison;
+        }
+      }
+      return 0;
+    }};
+    const auto begin{std::partition_point(changes->second.begin(), changes->second.end(), [&compare_bound](const TripleChange& change) {
+      return compare_bound(change) < 0;
+    })};
+    const auto end{std::partition_point(begin, changes->second.end(), [&compare_bound](const TripleChange& change) {
+      return compare_bound(change) == 0;
+    })};
+
+    // terms which are new to the view can't match anything in the base.
+    bool in_base{true};
+    for (const auto position: POSITIONS) {
+      in_base = in_base && key.term(position) <= m_layers->terms(position).base_max_id;
+    }
+
+    std::vector<ViewTriplesIterator::DeltaTriples> deltas;
+    for (std::size_t i{0}; i < m_layers->m_deltas.size(); i++) {
+      const auto& delta{m_layers->m_deltas[i]};
+      // a delta which lacks a term of the pattern has no matches.
+      std::array<std::size_t, 3> ids{0, 0, 0};
+      bool matchable{true};
+      for (const auto position: POSITIONS) {
+        const auto id{key.term(position)};
+        if (id != 0) {
+          ids[position_index(position)] = delta->string_to_id(id_to_string(id, position), position);
+          matchable = matchable && ids[position_index(position)] != 0;
+        }
+      }
+      if (matchable) {
+        deltas.push_back({delta->query_ptr(dldi::TriplePattern{ids[0], ids[1], ids[2]}),
+                          {&m_layers->m_terms[0].delta_ids[i], &m_layers->m_terms[1].delta_ids[i], &m_layers->m_terms[2].delta_ids[i]},
+                          m_layers->m_removals[i]});
+      }
+    }
+    return std::make_shared<ViewTriplesIterator>(*this, in_base ? m_layers->m_base->query_ptr(pattern) : nullptr, std::move(deltas), std::span<const TripleChange>{begin, end}, order);
+  }
+  auto DLDIView::query_ptr(const dldi::TripleOrder& order) const -> std::shared_ptr<dldi::ViewTriplesIterator> {
+    const auto changes{m_changes.find(order)};
+    if (changes == m_changes.end()) {
+      throw std::runtime_error("Triples not loaded!");
+    }
+    std::vector<ViewTriplesIterator::DeltaTriples> deltas;
+    for (std::size_t i{0}; i < m_layers->m_deltas.size(); i++) {
+      deltas.push_back({m_layers->m_deltas[i]->query_ptr(order),
+                        {&m_layers->m_terms[0].delta_ids[i], &m_layers->m_terms[1].delta_ids[i], &m_layers->m_terms[2].delta_ids[i]},
+                        m_layers->m_removals[i]});
+    }
+    return std::make_shared<ViewTriplesIterator>(*this, m_layers->m_base->query_ptr(order), std::move(deltas), changes->second, order);
+  }
+
+  auto DLDIView::query(const std::string& prefix, const dldi::TripleTermPosition& position) const -> dldi::ViewTermIterator {
+    const auto& changes{terms(position).changes};
+    const auto begin{std::lower_bound(changes.begin(), changes.end(), prefix, [](const std::pair<std::string, std::int64_t>& change, const std::string& term) {
+      return change.first < term;
+    })};
+    const auto end{std::find_if(begin, changes.end(), [&prefix](const std::pair<std::string, std::int64_t>& change) {
+      return !change.first.starts_with(prefix);
+    })};
+    std::vector<std::pair<csd::TermStringIterator, bool>> deltas;
+    for (std::size_t i{0}; i < m_layers->m_deltas.size(); i++) {
+      deltas.emplace_back(m_layers->m_deltas[i]->query(prefix, position), m_layers->m_removals[i]);
+    }
+    return ViewTermIterator{m_layers->m_base->query(prefix, position), std::move(deltas), std::span<const std::pair<std::string, std::int64_t>>{begin, end}};
+  }
+
+  auto ViewTriplesIterator::DeltaTriples::read() const -> QuantifiedTriple {
+    const auto triple{triples->read()};
+    return QuantifiedTriple{(*ids[0])[triple.subject()], (*ids[1])[triple.predicate()], (*ids[2])[triple.object()], triple.quantity()};
+  }
+
+  ViewTriplesIterator::ViewTriplesIterator(const DLDIView& view, std::shared_ptr<TriplesIterator> base, std::vector<DeltaTriples> deltas, std::span<const TripleChange> changes, const dldi::TripleOrder& order)
+    : m_view{&view},
+      m_base{std::move(base)},
+      m_deltas{std::move(deltas)},
+      m_changes{changes},
+      m_order{order} {
+    update_next();
+  }
+
+  auto ViewTriplesIterator::update_next() -> void {
+    while (true) {
+      // there are only a few layers, so the smallest triple is found by visiting each of them.
+      std::optional<QuantifiedTriple> smallest;
+      const auto visit{[this, &smallest](const QuantifiedTriple& triple) {
+        if (!smallest.has_value() || m_view->compare(triple, *smallest, m_order) < 0) {
+          smallest = triple;
+        }
+      }};
+      if (m_base != nullptr && m_base->has_next()) {
+        visit(m_base->read());
+      }
+      for (const auto& delta: m_deltas) {
+        if (delta.triples->has_next()) {
+          visit(delta.read());
+        }
+      }
+      if (m_change_index < m_changes.size()) {
+        visit(m_changes[m_change_index].triple);
+      }
+      if (!smallest.has_value()) {
+        m_has_next = false;
+        return;
+      }
+
+      // IDs of the view are the same for a term in all layers, so equal triples have equal IDs.
+      std::int64_t quantity{0};
+      if (m_base != nullptr && m_base->has_next() && m_base->read().equals(*smallest)) {
+        quantity += static_cast<std::int64_t>(m_base->read().quantity());
+        m_base->proceed();
+      }
+      for (auto& delta: m_deltas) {
+        if (delta.triples->has_next()) {
+          const auto triple{delta.read()};
+          if (triple.equals(*smallest)) {
+            const auto change{static_cast<std::int64_t>(triple.quantity())};
+            quantity += delta.removal ? -change : change;
+            delta.triples->proceed();
+          }
+        }
+      }
+      if (m_change_index < m_changes.size() && m_changes[m_change_index].triple.equals(*smallest)) {
+        quantity += m_changes[m_change_index].quantity;
+        m_change_index++;
+      }
+      if (quantity > 0) {
+        smallest->set_quantity(static_cast<std::size_t>(quantity));
+        m_next = *smallest;
+        m_has_next = true;
+        return;
+      }
+    }
+  }
+
+  auto ViewTriplesIterator::inner_proceed() -> void {
+    update_next();
+  }
+
+  ViewTermIterator::ViewTermIterator(csd::TermStringIterator base, std::vector<std::pair<csd::TermStringIterator, bool>> deltas, std::span<const std::pair<std::string, std::int64_t>> changes)
+    : m_base{std::move(base)},
+      m_deltas{std::move(deltas)},
+      m_changes{changes} {
+    update_next();
+  }
+
+  auto ViewTermIterator::update_next() -> void {
+    while (true) {
+      // std::string compares bytes as unsigned, like the tries.
+      std::optional<std::string> smallest;
+      const auto visit{[&smallest](const std::string& term) {
+        if (!smallest.has_value() || term < *smallest) {
+          smallest = term;
+        }
+      }};
+      if (m_base.has_next()) {
+        visit(m_base.read().first);
+      }
+      for (const auto& [delta, removal]: m_deltas) {
+        if (delta.has_next()) {
+          visit(delta.read().first);
+        }
+      }
+      if (m_change_index < m_changes.size()) {
+        visit(m_changes[m_change_index].first);
+      }
+      if (!smallest.has_value()) {
+        m_has_next = false;
+        return;
+      }
+
+      std::int64_t occurrences{0};
+      if (m_base.has_next() && m_base.read().first == *smallest) {
+        occurrences += static_cast<std::int64_t>(m_base.read().second);
+        m_base.proceed();
+      }
+      for (auto& [delta, removal]: m_deltas) {
+        if (delta.has_next()) {
+          const auto [term, quantity]{delta.read()};
+          if (term == *smallest) {
+            const auto change{static_cast<std::int64_t>(quantity)};
+            occurrences += removal ? -change : change;
+            delta.proceed();
+          }
+        }
+      }
+      if (m_change_index < m_changes.size() && m_changes[m_change_index].first == *smallest) {
+        occurrences += m_changes[m_change_index].second;
+        m_change_index++;
+      }
+      if (occurrences > 0) {
+        m_next = {std::move(*smallest), static_cast<std::size_t>(occurrences)};
+        m_has_next = true;
+        return;
+      }
+    }
+  }
+
+  auto ViewTermIterator::inner_proceed() -> void {
+    update_next();
+  }
+}
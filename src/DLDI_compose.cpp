@@ -5,9 +5,13 @@
 #include <ctime>
 #include <fcntl.h>
 #include <filesystem>
+#include <fstream>
 #include <functional>
+#include <future>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <sys/mman.h>
@@ -18,12 +22,19 @@
 
 #include <DLDI.hpp>
 
+#include "./rdf/ParallelLineParser.hpp"
 #include "./rdf/SerdParser.hpp"
+#include "./triples/ExternalTriplesSorter.hpp"
+#include "./triples/TriplesBlock.hpp"
 #include "./triples/TriplesReader.hpp"
+#include "./triples/TriplesStreamWriter.hpp"
 #include "./triples/TriplesWriter.hpp"
 #include <dictionary/Dictionary.hpp>
+#include <dictionary/trie/TrieBuilder.hpp>
 
 #include "./Composer.hpp"
+#include "./dictionary/ExternalTermSorter.hpp"
+#include "./dictionary/TermEncodingCache.hpp"
 
 inline auto get_source_info(const std::filesystem::path& path) -> dldi::SourceInfo {
   dldi::SourceInfo info;
@@ -49,7 +60,11 @@ namespace dldi {
 
   auto DLDI::compose(const std::vector<std::filesystem::path>& addition_paths,
                      const std::vector<std::filesystem::path>& subtraction_paths,
-                     const std::filesystem::path& output_path) -> void {
+                     const std::filesystem::path& output_path,
+                     bool order_preserving_ids,
+                     const std::size_t& memory_budget,
+                     const std::size_t& num_threads,
+                     WriteThrottle* throttle) -> void {
     std::vector<dldi::SourceInfo> additions;
     for (const auto path: addition_paths) {
       additions.push_back(get_source_info(path));
@@ -74,51 +89,253 @@ namespace dldi {
       if (first.type == dldi::SourceType::DynamicLinkedDataIndex) {
         throw std::runtime_error("Doesn't make sense, use `cp -R` instead.");
       }
-      DLDI::from_ptld(first.path, output_path, "https://example.com/");
+      if (first.type == dldi::SourceType::PlainTextLinkedData_Sorted) {
+        DLDI::from_sorted_ptld(first.path, output_path, "https://example.com/", memory_budget);
+      } else {
+        DLDI::from_ptld(first.path, output_path, "https://example.com/", memory_budget);
+      }
       return;
     }
 
-    Composer composer;
-    composer.zip(additions, subtractions, output_path);
+    Composer composer{throttle};
+    composer.zip(additions, subtractions, output_path, order_preserving_ids, num_threads);
+  }
+
+  /**
+   * Save in-memory dictionaries and triples as a DLDI instance, along with its statistics. 
+  */
+  inline auto save_dldi(Dictionary& subjects, Dictionary& predicates, Dictionary& objects, TriplesWriter& triples, const std::filesystem::path& output_path) -> void {
+    std::filesystem::create_directory(output_path);
+
+    // Switch to the IDs the dictionaries get when saved,
+    // which sort like their terms, so sorting needs no dictionary lookups.
+    triples.remap(subjects.lexicographic_ids(), predicates.lexicographic_ids(), objects.lexicographic_ids());
+
+    // The orders are sorted one after another, in place, each sort using all cores,
+    // so at most the triples and one scratch buffer are in memory.
+    const auto num_threads{std::max<std::size_t>(std::thread::hardware_concurrency(), 1)};
+    StatisticsCollector statistics;
+    for (auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
+      triples.save_sorted(dldi::TriplesReader::triples_file_path(output_path, order), order, num_threads, &statistics);
+    }
+
+    subjects.save(Dictionary::dictionary_file_path(output_path, dldi::TripleTermPosition::subject));
+    predicates.save(Dictionary::dictionary_file_path(output_path, dldi::TripleTermPosition::predicate));
+    objects.save(Dictionary::dictionary_file_path(output_path, dldi::TripleTermPosition::object));
+    statistics.finish(output_path).save(Statistics::statistics_file_path(output_path));
   }
 
-  inline auto parser_type(const std::string& extension) -> rdf::SerializationFormat {
-    if (extension == ".nq")
-      return rdf::SerializationFormat::NQuads;
-    if (extension == ".nt")
-      return rdf::SerializationFormat::NTriples;
-    if (extension == ".trig")
-      return rdf::SerializationFormat::TriG;
-    if (extension == ".ttl")
-      return rdf::SerializationFormat::Turtle;
-    throw std::runtime_error("Serd parser only supports N-Triples, N-Quads, TriG, and Turtle.");
+  auto DLDI::from_statements(const std::vector<std::pair<dldi::TermTriple, std::size_t>>& statements, const std::filesystem::path& output_path) -> void {
+    if (statements.empty()) {
+      throw std::runtime_error("Need at least one statement");
+    }
+    Dictionary subjects;
+    Dictionary predicates;
+    Dictionary objects;
+    TriplesWriter triples;
+    for (const auto& [terms, quantity]: statements) {
+      if (quantity == 0) {
+        continue;
+      }
+      const auto& [subject, predicate, object]{terms};
+      triples.add(QuantifiedTriple{subjects.add(subject, quantity), predicates.add(predicate, quantity), objects.add(object, quantity), quantity});
+    }
+    save_dldi(subjects, predicates, objects, triples, output_path);
   }
 
-  auto DLDI::from_ptld(const std::filesystem::path& input_path, const std::filesystem::path& output_path, const std::string& base_iri) -> void {
-    dldi::Dictionary subjects{};
-    dldi::Dictionary predicates{};
-    dldi::Dictionary objects{};
+  auto DLDI::from_ptld(const std::filesystem::path& input_path, const std::filesystem::path& output_path, const std::string& base_iri, const std::size_t& memory_budget) -> void {
+    auto subjects{std::make_unique<dldi::Dictionary>()};
+    auto predicates{std::make_unique<dldi::Dictionary>()};
+    auto objects{std::make_unique<dldi::Dictionary>()};
     dldi::TriplesWriter triples{};
+    // Most statements repeat terms of recent ones (predicates in particular), 
+    // which the caches encode without navigating the tries.
+    dldi::TermEncodingCache subject_ids{*subjects};
+    dldi::TermEncodingCache predicate_ids{*predicates};
+    dldi::TermEncodingCache object_ids{*objects};
+    const auto flush_caches{[&]() {
+      subject_ids.flush();
+      predicate_ids.flush();
+      object_ids.flush();
+    }};
+
+    // Over the memory budget, the data parsed so far is spilled to disk as a run, 
+    // and the runs are composed into the output at the end.
+    const std::filesystem::path runs_dir{output_path.string() + ".runs"};
+    std::vector<std::filesystem::path> runs;
+    // The memory of everything which grows with the run, up to and including saving it.
+    const auto footprint{[&]() {
+      return subjects->memory_usage() + predicates->memory_usage() + objects->memory_usage() +
+             subject_ids.memory_usage() + predicate_ids.memory_usage() + object_ids.memory_usage() +
+             triples.memory_usage() +
+             // the translations to lexicographic IDs, made when saving.
+             (subjects->size() + predicates->size() + objects->size()) * sizeof(std::size_t);
+    }};
+    const auto spill{[&]() {
+      const auto run_path{runs_dir / ("run-" + std::to_string(runs.size()))};
+      std::filesystem::create_directories(runs_dir);
+      flush_caches();
+      save_dldi(*subjects, *predicates, *objects, triples, run_path);
+      runs.push_back(run_path);
+      subjects = std::make_unique<dldi::Dictionary>();
+      predicates = std::make_unique<dldi::Dictionary>();
+      objects = std::make_unique<dldi::Dictionary>();
+      subject_ids = dldi::TermEncodingCache{*subjects};
+      predicate_ids = dldi::TermEncodingCache{*predicates};
+      object_ids = dldi::TermEncodingCache{*objects};
+      triples = dldi::TriplesWriter{};
+    }};
+
+    const auto on_statement{[&](const std::string& subject_str, const std::string& predicate_str, const std::string& object_str) -> void {
+      const auto subject{subject_ids.add(subject_str)};
+      const auto predicate{predicate_ids.add(predicate_str)};
+      const auto object{object_ids.add(object_str)};
+      triples.add(subject, predicate, object);
+      if (memory_budget > 0 && footprint() >= memory_budget) {
+        spill();
+      }
+    }};
+    rdf::parse_file(input_path, on_statement, base_iri);
+
+    flush_caches();
+    if (runs.empty()) {
+      save_dldi(*subjects, *predicates, *objects, triples, output_path);
+      return;
+    }
+    if (triples.size() > 0) {
+      spill();
+    }
+    std::vector<dldi::SourceInfo> additions;
+    for (const auto& run: runs) {
+      additions.push_back(get_source_info(run));
+    }
+    std::filesystem::create_directory(output_path);
+    Composer composer;
+    composer.zip(additions, {}, output_path);
+    std::filesystem::remove_all(runs_dir);
+  }
+
+  /**
+   * Stream statements which are grouped by subject, with subjects in the order of their terms or of their N-Triples form. 
+   * Subjects get provisional IDs in input order, and the subject dictionary is built from an external sort of their terms. 
+   * All orders are then sorted from the provisional triples with bounded memory. 
+  */
+  inline auto stream_sorted_ptld(const std::filesystem::path& input_path,
+                                 const std::filesystem::path& output_path,
+                                 const std::filesystem::path& runs_dir,
+                                 const std::string& base_iri,
+                                 const std::size_t& memory_budget) -> void {
+    std::filesystem::create_directories(output_path);
+    std::filesystem::create_directories(runs_dir);
+
+    ExternalTermSorter subjects{runs_dir, "subjects", memory_budget / 2};
+    Dictionary predicates;
+    Dictionary objects;
+    TermEncodingCache predicate_ids{predicates};
+    TermEncodingCache object_ids{objects};
+
+    // No term has its final ID before all input is read, 
+    // so the triples are first written with the IDs they have so far. 
+    const auto provisional_path{runs_dir / "SPO.provisional"};
+    TriplesStreamWriter provisional{provisional_path, TripleOrder::SPO};
+    std::size_t num_subjects{0};
+    std::string subject;
+    std::size_t subject_occurrences{0};
+    // Subjects must increase in one of these orders, which keeps each subject in a single group. 
+    std::string previous_serialized;
+    bool in_term_order{true};
+    bool in_serialized_order{true};
+    const auto start_subject{[&](const std::string& next) {
+      if (num_subjects > 0) {
+        subjects.add(subject, num_subjects, subject_occurrences);
+      }
+      auto serialized{next.starts_with("_:") ? next : "<" + next + ">"};
+      if (num_subjects > 0) {
+        in_term_order = in_term_order && subject < next;
+        in_serialized_order = in_serialized_order && previous_serialized < serialized;
+        if (!in_term_order && !in_serialized_order) {
+          throw UnsortedInput("Subject `" + next + "` follows `" + subject + "`");
+        }
+      }
+      previous_serialized = std::move(serialized);
+      subject = next;
+      subject_occurrences = 0;
+      num_subjects++;
+    }};
     rdf::SerdParser parser{
       input_path,
-      [&subjects, &predicates, &objects, &triples](const std::string& subject_str, const std::string& predicate_str, const std::string& object_str) -> void {
-        const auto subject{subjects.add(subject_str, 1)};
-        const auto predicate{predicates.add(predicate_str, 1)};
-        const auto object{objects.add(object_str, 1)};
-        triples.add(subject, predicate, object);
+      [&](const std::string& subject_str, const std::string& predicate_str, const std::string& object_str) {
+        if (num_subjects == 0 || subject_str != subject) {
+          start_subject(subject_str);
+        }
+        subject_occurrences++;
+        provisional.write(QuantifiedTriple{num_subjects, predicate_ids.add(predicate_str), object_ids.add(object_str), 1});
       },
       base_iri,
-      parser_type(input_path.extension())};
+      rdf::format_from_extension(input_path.extension())};
+    if (num_subjects > 0) {
+      subjects.add(subject, num_subjects, subject_occurrences);
+    }
+    provisional.close();
+    predicate_ids.flush();
+    object_ids.flush();
 
-    std::filesystem::create_directory(output_path);
+    // The subject trie is built in memory from the sorted terms, and saved in one go.
+    std::vector<std::size_t> subject_ranks(num_subjects + 1, 0);
+    {
+      csd::TrieBuilder subject_trie;
+      subjects.for_each([&](const std::string& term, const std::size_t& id, const std::size_t& occurrences) {
+        subject_trie.add(term, occurrences);
+        subject_ranks.at(id) = subject_trie.numTerms();
+      });
+      std::ofstream out{Dictionary::dictionary_file_path(output_path, TripleTermPosition::subject), std::ios::binary | std::ios::trunc};
+      subject_trie.save(out);
+    }
+    const auto predicate_ranks{predicates.lexicographic_ids()};
+    const auto object_ranks{objects.lexicographic_ids()};
+    predicates.save(Dictionary::dictionary_file_path(output_path, TripleTermPosition::predicate));
+    objects.save(Dictionary::dictionary_file_path(output_path, TripleTermPosition::object));
 
-    for (auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
-      triples.sort(subjects, predicates, objects, order);
-      triples.save(dldi::TriplesReader::triples_file_path(output_path, order));
+    std::vector<ExternalTriplesSorter> sorters;
+    for (const auto order: EnumMapping::TRIPLE_ORDERS) {
+      sorters.emplace_back(runs_dir, order, memory_budget / std::size(EnumMapping::TRIPLE_ORDERS));
+    }
+    {
+      const TriplesReader reader{provisional_path};
+      std::vector<QuantifiedTriple> block(TRIPLES_PER_BLOCK);
+      for (std::size_t b{0}; b < reader.num_blocks(); b++) {
+        const auto num_triples{reader.decode_block(b, block.data())};
+        for (std::size_t i{0}; i < num_triples; i++) {
+          const QuantifiedTriple triple{subject_ranks.at(block[i].subject()), predicate_ranks.at(block[i].predicate()), object_ranks.at(block[i].object()), block[i].quantity()};
+          for (auto& sorter: sorters) {
+            sorter.add(triple);
+          }
+        }
+      }
     }
 
-    subjects.save(Dictionary::dictionary_file_path(output_path, dldi::TripleTermPosition::subject));
-    predicates.save(Dictionary::dictionary_file_path(output_path, dldi::TripleTermPosition::predicate));
-    objects.save(Dictionary::dictionary_file_path(output_path, dldi::TripleTermPosition::object));
+    StatisticsCollector statistics;
+    std::vector<std::future<void>> saves;
+    for (std::size_t i{0}; i < sorters.size(); i++) {
+      saves.push_back(std::async(std::launch::async, [&sorters, &output_path, &statistics, i]() {
+        sorters[i].save(TriplesReader::triples_file_path(output_path, sorters[i].order()), &statistics);
+      }));
+    }
+    for (auto& save: saves) {
+      save.get();
+    }
+    statistics.finish(output_path).save(Statistics::statistics_file_path(output_path));
+    std::filesystem::remove_all(runs_dir);
+  }
+
+  auto DLDI::from_sorted_ptld(const std::filesystem::path& input_path, const std::filesystem::path& output_path, const std::string& base_iri, const std::size_t& memory_budget) -> void {
+    const std::filesystem::path runs_dir{output_path.string() + ".runs"};
+    try {
+      stream_sorted_ptld(input_path, output_path, runs_dir, base_iri, memory_budget);
+    } catch (const UnsortedInput&) {
+      std::filesystem::remove_all(runs_dir);
+      std::filesystem::remove_all(output_path);
+      throw;
+    }
   }
 }
@@ -0,0 +1,411 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+
+#include <DeltaStack.hpp>
+
+#include "./triples/TriplesReader.hpp"
+
+namespace {
+  /**
+   * Flush a file or directory to disk, e.g. a directory after files were created in it or renamed into it.
+  */
+  auto sync_path(const std::filesystem::path& path) -> void {
+    const int fd{open(path.c_str(), O_RDONLY)};
+    if (fd == -1) {
+      throw std::runtime_error("Could not open " + path.string() + " to sync it");
+    }
+    const auto result{fsync(fd)};
+    close(fd);
+    if (result == -1) {
+      throw std::runtime_error("Failed to sync " + path.string());
+    }
+  }
+
+  /**
+   * Flush the files of a DLDI directory to disk, along with the directory itself.
+  */
+  auto sync_layer(const std::filesystem::path& dir) -> void {
+    for (const auto& entry: std::filesystem::directory_iterator{dir}) {
+      if (entry.is_regular_file()) {
+        sync_path(entry.path());
+      }
+    }
+    sync_path(dir);
+  }
+}
+
+namespace dldi {
+  struct DeltaStack::LayerLease {
+    std::filesystem::path path;
+    bool retired{false};
+    ~LayerLease() {
+      if (retired) {
+        std::error_code ignored;
+        std::filesystem::remove_all(path, ignored);
+      }
+    }
+  };
+
+  DeltaStack::DeltaStack(const std::filesystem::path& dir, const std::size_t& flush_threshold)
+    : m_dir{dir},
+      m_flush_threshold{flush_threshold} {
+    std::ifstream manifest{manifest_path()};
+    if (!manifest) {
+      throw std::runtime_error("Missing file " + manifest_path().string());
+    }
+    std::string kind;
+    std::string name;
+    while (manifest >> kind >> name) {
+      if (kind == "wal") {
+        m_wal = name;
+        continue;
+      }
+      if (kind != "base" && kind != "add" && kind != "remove") {
+        throw std::runtime_error("Unrecognized layer in " + manifest_path().string() + ": " + kind);
+      }
+      if ((kind == "base") != m_layers.empty()) {
+        throw std::runtime_error("The base must be the first layer of " + manifest_path().string());
+      }
+      m_layers.push_back(StackLayer{name, kind == "remove", layer_size(name)});
+    }
+    if (m_layers.empty()) {
+      throw std::runtime_error("No base in " + manifest_path().string());
+    }
+    // leftovers of interrupted compactions aren't in the manifest, but their names stay taken.
+    for (const auto& entry: std::filesystem::directory_iterator{m_dir}) {
+      const auto filename{entry.path().filename().string()};
+      if (filename.starts_with("layer-")) {
+        m_next_layer = std::max(m_next_layer, std::stoul(filename.substr(6)) + 1);
+      }
+    }
+    replay_wal();
+  }
+
+  DeltaStack::~DeltaStack() {
+    if (m_wal_fd != -1) {
+      close(m_wal_fd);
+    }
+  }
+
+  auto DeltaStack::create(const std::filesystem::path& dir, const std::filesystem::path& base) -> void {
+    if (std::filesystem::exists(dir)) {
+      throw std::runtime_error("There is already something at " + dir.string());
+    }
+    DLDI{base};
+    std::filesystem::create_directories(dir);
+    std::filesystem::copy(base, dir / "layer-0", std::filesystem::copy_options::recursive);
+    std::ofstream manifest{dir / "manifest"};
+    manifest << "base layer-0\n";
+  }
+
+  auto DeltaStack::layer_size(const std::string& name) const -> std::size_t {
+    return std::filesystem::file_size(dldi::TriplesReader::triples_file_path(m_dir / name, dldi::TripleOrder::SPO));
+  }
+
+  auto DeltaStack::layer_path(const StackLayer& layer) const -> std::filesystem::path {
+    return m_dir / layer.name;
+  }
+
+  auto DeltaStack::save_manifest() const -> void {
+    write_manifest(m_layers, m_wal);
+    // the rename is on disk before this returns.
+    sync_path(m_dir);
+  }
+
+  auto DeltaStack::write_manifest(const std::vector<StackLayer>& layers, const std::string& wal) const -> void {
+    const auto tmp_path{m_dir / "manifest.tmp"};
+    {
+      std::ofstream manifest{tmp_path, std::ios::trunc};
+      for (std::size_t i{0}; i < layers.size(); i++) {
+        manifest << (i == 0 ? "base" : layers[i].removal ? "remove" :
+                                                             "add")
+                 << " " << layers[i].name << "\n";
+      }
+      if (!wal.empty()) {
+        manifest << "wal " << wal << "\n";
+      }
+      if (!manifest.flush()) {
+        throw std::runtime_error("Failed to write " + tmp_path.string());
+      }
+    }
+    // the manifest is on disk before it replaces the old one.
+    sync_path(tmp_path);
+    std::filesystem::rename(tmp_path, manifest_path());
+  }
+
+  auto DeltaStack::next_layer_name() -> std::string {
+    return "layer-" + std::to_string(m_next_layer++);
+  }
+
+  auto DeltaStack::new_layer() -> StackLayer {
+    std::lock_guard lock{m_mutex};
+    return StackLayer{next_layer_name()};
+  }
+
+  /**
+   * A log record is the sign of the change, followed by each term's length and bytes.
+  */
+  auto DeltaStack::replay_wal() -> void {
+    if (m_wal.empty() || !std::filesystem::exists(m_dir / m_wal)) {
+      return;
+    }
+    std::ifstream wal{m_dir / m_wal, std::ios::binary};
+    std::stringstream contents;
+    contents << wal.rdbuf();
+    const auto data{contents.str()};
+    std::size_t offset{0};
+    while (offset < data.size()) {
+      auto position{offset + 1};
+      std::array<std::string, 3> terms;
+      auto complete{true};
+      for (auto& term: terms) {
+        std::uint64_t length;
+        if (position + sizeof(length) > data.size()) {
+          complete = false;
+          break;
+        }
+        std::memcpy(&length, data.data() + position, sizeof(length));
+        position += sizeof(length);
+        if (position + length > data.size()) {
+          complete = false;
+          break;
+        }
+        term.assign(data, position, length);
+        position += length;
+      }
+      if (!complete) {
+        break;
+      }
+      const dldi::TermTriple triple{terms[0], terms[1], terms[2]};
+      if ((m_buffer[triple] += data[offset] == '-' ? -1 : 1) == 0) {
+        m_buffer.erase(triple);
+      }
+      offset = position;
+    }
+    // a record which was cut off was never acknowledged, so it is dropped.
+    if (offset < data.size()) {
+      std::filesystem::resize_file(m_dir / m_wal, offset);
+    }
+  }
+
+  auto DeltaStack::append(const dldi::TermTriple& triple, const std::int64_t& quantity) -> void {
+    if (m_wal.empty()) {
+      m_wal = next_layer_name() + ".wal";
+      save_manifest();
+    }
+    if (m_wal_fd == -1) {
+      m_wal_fd = open((m_dir / m_wal).c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+      if (m_wal_fd == -1) {
+        throw std::runtime_error("Could not open write-ahead log " + (m_dir / m_wal).string());
+      }
+      // the log may have just been created, which only lasts once the directory is synced.
+      sync_path(m_dir);
+    }
+    std::string record(1, quantity < 0 ? '-' : '+');
+    for (const auto* term: {&std::get<0>(triple), &std::get<1>(triple), &std::get<2>(triple)}) {
+      const std::uint64_t length{term->size()};
+      record.append(reinterpret_cast<const char*>(&length), sizeof(length));
+      record.append(*term);
+    }
+    std::size_t written{0};
+    while (written < record.size()) {
+      const auto result{write(m_wal_fd, record.data() + written, record.size() - written)};
+      if (result == -1) {
+        throw std::runtime_error("Failed to write to write-ahead log " + (m_dir / m_wal).string());
+      }
+      written += result;
+    }
+    if (fdatasync(m_wal_fd) == -1) {
+      throw std::runtime_error("Failed to sync write-ahead log " + (m_dir / m_wal).string());
+    }
+  }
+
+  auto DeltaStack::insert(const std::string& subject, const std::string& predicate, const std::string& object) -> void {
+    const dldi::TermTriple triple{subject, predicate, object};
+    std::lock_guard lock{m_mutex};
+    append(triple, 1);
+    if (++m_buffer[triple] == 0) {
+      m_buffer.erase(triple);
+    }
+    if (m_buffer.size() > m_flush_threshold) {
+      flush_unlocked();
+    }
+  }
+
+  auto DeltaStack::remove(const std::string& subject, const std::string& predicate, const std::string& object) -> void {
+    const dldi::TermTriple triple{subject, predicate, object};
+    std::lock_guard lock{m_mutex};
+    // a removal of something which isn't there would make every later compose of the stack fail.
+    if (quantity_unlocked(triple) <= 0) {
+      throw std::runtime_error("Tried to remove a triple which isn't in the stack: " + subject + " " + predicate + " " + object);
+    }
+    append(triple, -1);
+    if (--m_buffer[triple] == 0) {
+      m_buffer.erase(triple);
+    }
+    if (m_buffer.size() > m_flush_threshold) {
+      flush_unlocked();
+    }
+  }
+
+  auto DeltaStack::flush() -> void {
+    std::lock_guard lock{m_mutex};
+    flush_unlocked();
+  }
+
+  auto DeltaStack::flush_unlocked() -> void {
+    std::array<std::vector<std::pair<dldi::TermTriple, std::size_t>>, 2> statements;
+    for (const auto& [triple, quantity]: m_buffer) {
+      if (quantity > 0) {
+        statements[0].emplace_back(triple, quantity);
+      } else {
+        statements[1].emplace_back(triple, -quantity);
+      }
+    }
+    // the new layers and the end of the log are recorded in the same manifest, so the changes are never applied twice.
+    // Until it replaces the old one, the stack is left as it was, and the new layers are removed if anything fails.
+    auto layers{m_layers};
+    std::vector<std::string> created;
+    try {
+      for (const auto removal: {false, true}) {
+        if (statements[removal].empty()) {
+          continue;
+        }
+        const auto name{next_layer_name()};
+        created.push_back(name);
+        DLDI::from_statements(statements[removal], m_dir / name);
+        sync_layer(m_dir / name);
+        layers.push_back(StackLayer{name, removal, layer_size(name)});
+      }
+      write_manifest(layers, "");
+    } catch (...) {
+      for (const auto& name: created) {
+        std::error_code ignored;
+        std::filesystem::remove_all(m_dir / name, ignored);
+      }
+      throw;
+    }
+    m_layers = std::move(layers);
+    m_view_layers.reset();
+    m_buffer.clear();
+    const auto wal{std::exchange(m_wal, "")};
+    if (m_wal_fd != -1) {
+      close(m_wal_fd);
+      m_wal_fd = -1;
+    }
+    // the log is only removed once the manifest which replaces it is sure to be on disk.
+    sync_path(m_dir);
+    if (!wal.empty()) {
+      std::filesystem::remove(m_dir / wal);
+    }
+  }
+
+  auto DeltaStack::push(const std::filesystem::path& delta, bool removal) -> void {
+    DLDI{delta};
+    auto layer{new_layer()};
+    layer.removal = removal;
+    try {
+      std::filesystem::rename(delta, layer_path(layer));
+    } catch (const std::filesystem::filesystem_error&) {
+      // e.g. the delta is on another filesystem.
+      std::filesystem::copy(delta, layer_path(layer), std::filesystem::copy_options::recursive);
+      std::filesystem::remove_all(delta);
+    }
+    layer.size = layer_size(layer.name);
+    sync_layer(layer_path(layer));
+    std::lock_guard lock{m_mutex};
+    m_layers.push_back(layer);
+    m_view_layers.reset();
+    save_manifest();
+  }
+
+  auto DeltaStack::layers() const -> std::vector<StackLayer> {
+    std::lock_guard lock{m_mutex};
+    return m_layers;
+  }
+
+  auto DeltaStack::view() const -> dldi::DLDIView {
+    std::lock_guard lock{m_mutex};
+    return view_unlocked(m_buffer);
+  }
+
+  auto DeltaStack::view_unlocked(dldi::BufferedChanges buffer) const -> dldi::DLDIView {
+    if (!m_view_layers) {
+      std::vector<ViewDelta> deltas;
+      for (std::size_t i{1}; i < m_layers.size(); i++) {
+        deltas.push_back(ViewDelta{layer_path(m_layers[i]), m_layers[i].removal});
+      }
+      auto leases{std::make_shared<std::vector<std::shared_ptr<LayerLease>>>()};
+      for (const auto& layer: m_layers) {
+        auto& lease{m_leases[layer.name]};
+        if (!lease) {
+          lease = std::make_shared<LayerLease>(layer_path(layer));
+        }
+        leases->push_back(lease);
+      }
+      m_view_layers = std::make_shared<ViewLayers>(layer_path(m_layers[0]), deltas, leases);
+    }
+    return DLDIView{m_view_layers, std::move(buffer)};
+  }
+
+  auto DeltaStack::quantity_unlocked(const dldi::TermTriple& triple) -> std::int64_t {
+    const auto buffered{m_buffer.find(triple)};
+    std::int64_t result{buffered == m_buffer.end() ? 0 : buffered->second};
+    auto view{view_unlocked({})};
+    std::array<std::size_t, 3> ids;
+    for (const auto position: {TripleTermPosition::subject, TripleTermPosition::predicate, TripleTermPosition::object}) {
+      view.ensure_loaded(position);
+      const auto& term{position == TripleTermPosition::subject ? std::get<0>(triple) : position == TripleTermPosition::predicate ? std::get<1>(triple) : std::get<2>(triple)};
+      ids[static_cast<std::size_t>(position)] = view.string_to_id(term, position);
+      if (ids[static_cast<std::size_t>(position)] == 0) {
+        return result;
+      }
+    }
+    const dldi::TriplePattern pattern{ids[0], ids[1], ids[2]};
+    view.prepare_for_query(pattern);
+    const auto matches{view.query_ptr(pattern)};
+    if (matches->has_next()) {
+      result += static_cast<std::int64_t>(matches->read().quantity());
+    }
+    return result;
+  }
+
+  auto DeltaStack::replace(const std::vector<StackLayer>& replaced, StackLayer replacement) -> void {
+    if (replaced.empty()) {
+      throw std::runtime_error("Nothing to replace");
+    }
+    replacement.size = layer_size(replacement.name);
+    {
+      std::lock_guard lock{m_mutex};
+      const auto is_replaced{[&replaced](const StackLayer& layer) {
+        return std::ranges::any_of(replaced, [&layer](const StackLayer& r) { return r.name == layer.name; });
+      }};
+      if (std::ranges::count_if(m_layers, is_replaced) != static_cast<std::ptrdiff_t>(replaced.size())) {
+        throw std::runtime_error("Tried to replace layers which aren't in the stack");
+      }
+      const auto first{std::ranges::find_if(m_layers, is_replaced)};
+      *first = replacement;
+      m_layers.erase(std::remove_if(first + 1, m_layers.end(), is_replaced), m_layers.end());
+      m_view_layers.reset();
+      save_manifest();
+      // layers which views still use are deleted along with the last of those views.
+      for (const auto& layer: replaced) {
+        const auto lease{m_leases.find(layer.name)};
+        if (lease == m_leases.end()) {
+          std::filesystem::remove_all(layer_path(layer));
+          continue;
+        }
+        lease->second->retired = true;
+        m_leases.erase(lease);
+      }
+    }
+  }
+}
@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include <Statistics.hpp>
+
+#include "./triples/TriplesBlock.hpp"
+#include "./triples/TriplesReader.hpp"
+#include <dictionary/Dictionary.hpp>
+
+namespace dldi {
+  /**
+   * Visit the triples of an order, block by block.
+  */
+  template <typename F>
+  inline auto for_each_triple(const std::filesystem::path& dldi_dir, const dldi::TripleOrder& order, F&& f) -> void {
+    const TriplesReader reader{TriplesReader::triples_file_path(dldi_dir, order)};
+    std::vector<QuantifiedTriple> block(TRIPLES_PER_BLOCK);
+    for (std::size_t i{0}; i < reader.num_blocks(); i++) {
+      const auto n{reader.decode_block(i, block.data())};
+      for (std::size_t j{0}; j < n; j++) {
+        f(block[j]);
+      }
+    }
+  }
+
+  auto Statistics::compute(const std::filesystem::path& dldi_dir) -> Statistics {
+    StatisticsCollector collector;
+    for (const auto order: {dldi::TripleOrder::PSO, dldi::TripleOrder::POS, dldi::TripleOrder::SPO}) {
+      for_each_triple(dldi_dir, order, [&](const QuantifiedTriple& triple) {
+        collector.add(order, triple);
+      });
+    }
+    return collector.finish(dldi_dir);
+  }
+
+  auto StatisticsCollector::PredicateSetHash::operator()(const std::vector<std::size_t>& predicates) const -> std::size_t {
+    std::size_t hash{predicates.size()};
+    for (const auto& predicate: predicates) {
+      hash ^= std::hash<std::size_t>{}(predicate) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+  }
+
+  auto StatisticsCollector::add(const dldi::TripleOrder& order, const QuantifiedTriple& triple) -> void {
+    // within a predicate, a new subject (in PSO) or object (in POS) starts wherever it differs from the previous triple.
+    if (order == dldi::TripleOrder::PSO) {
+      auto& stats{m_predicates[triple.predicate()]};
+      stats.triples++;
+      if (stats.triples == 1 || triple.subject() != m_previous_pso.subject()) {
+        stats.distinct_subjects++;
+      }
+      m_triples++;
+      m_previous_pso = triple;
+    } else if (order == dldi::TripleOrder::POS) {
+      if (m_previous_pos.predicate() != triple.predicate() || triple.object() != m_previous_pos.object()) {
+        m_distinct_objects[triple.predicate()]++;
+      }
+      m_previous_pos = triple;
+    } else if (order == dldi::TripleOrder::SPO) {
+      if (triple.subject() != m_subject) {
+        finish_subject();
+        m_subject = triple.subject();
+      }
+      m_subject_predicates.push_back(triple.predicate());
+      m_subject_triples++;
+    }
+  }
+
+  auto StatisticsCollector::finish_subject() -> void {
+    if (m_subject_triples == 0) {
+      return;
+    }
+    // SPO lists the predicates of a subject in order.
+    m_subject_predicates.erase(std::unique(m_subject_predicates.begin(), m_subject_predicates.end()), m_subject_predicates.end());
+    auto found{m_sets.find(m_subject_predicates)};
+    if (found == m_sets.end()) {
+      CharacteristicSet set;
+      if (m_sets.size() == MAX_COUNTED_CHARACTERISTIC_SETS) {
+        const auto least{m_sets_by_subjects.begin()};
+        const auto replaced{m_sets.find(*least->second)};
+        set = replaced->second;
+        m_sets_by_subjects.erase(least);
+        m_sets.erase(replaced);
+      }
+      found = m_sets.emplace(m_subject_predicates, set).first;
+    } else {
+      m_sets_by_subjects.erase({found->second.subjects, &found->first});
+    }
+    found->second.subjects++;
+    found->second.triples += m_subject_triples;
+    m_sets_by_subjects.emplace(found->second.subjects, &found->first);
+    m_subject_predicates.clear();
+    m_subject_triples = 0;
+  }
+
+  auto StatisticsCollector::finish(const std::filesystem::path& dldi_dir) -> Statistics {
+    finish_subject();
+    Statistics result;
+    for (const auto position: {dldi::TripleTermPosition::subject, dldi::TripleTermPosition::predicate, dldi::TripleTermPosition::object}) {
+      const Dictionary dict{Dictionary::dictionary_file_path(dldi_dir, position)};
+      result.occurrence_histograms[static_cast<std::size_t>(position)] = dict.occurrence_histogram();
+    }
+    result.triples = m_triples;
+    result.predicates = std::move(m_predicates);
+    for (const auto& [predicate, distinct_objects]: m_distinct_objects) {
+      result.predicates[predicate].distinct_objects = distinct_objects;
+    }
+    result.characteristic_sets.reserve(m_sets.size());
+    for (auto& [predicates, set]: m_sets) {
+      set.predicates = predicates;
+      result.characteristic_sets.push_back(std::move(set));
+    }
+    // the order among equally common sets doesn't depend on the hash table.
+    std::sort(result.characteristic_sets.begin(), result.characteristic_sets.end(), [](const CharacteristicSet& lhs, const CharacteristicSet& rhs) {
+      return lhs.subjects != rhs.subjects ? lhs.subjects > rhs.subjects : lhs.predicates < rhs.predicates;
+    });
+    if (result.characteristic_sets.size() > Statistics::MAX_CHARACTERISTIC_SETS) {
+      result.characteristic_sets.resize(Statistics::MAX_CHARACTERISTIC_SETS);
+    }
+    return result;
+  }
+
+  /**
+   * The file is a sequence of size_t: the number of triples, the predicates, the histograms, and the characteristic sets,
+   * each list preceded by its length.
+  */
+  auto Statistics::save(const std::filesystem::path& path) const -> void {
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    if (!out.good()) {
+      throw std::runtime_error("Error opening file to save data: " + path.string());
+    }
+    const auto write{[&out](const std::size_t& value) {
+      out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }};
+    write(triples);
+    write(predicates.size());
+    for (const auto& [id, stats]: predicates) {
+      write(id);
+      write(stats.triples);
+      write(stats.distinct_subjects);
+      write(stats.distinct_objects);
+    }
+    for (const auto& histogram: occurrence_histograms) {
+      write(histogram.size());
+      for (const auto& count: histogram) {
+        write(count);
+      }
+    }
+    write(characteristic_sets.size());
+    for (const auto& set: characteristic_sets) {
+      write(set.subjects);
+      write(set.triples);
+      write(set.predicates.size());
+      for (const auto& predicate: set.predicates) {
+        write(predicate);
+      }
+    }
+    if (!out.flush()) {
+      throw std::runtime_error("Failed to write " + path.string());
+    }
+  }
+
+  auto Statistics::load(const std::filesystem::path& path) -> Statistics {
+    std::ifstream in{path, std::ios::binary};
+    if (!in.good()) {
+      throw std::runtime_error("Missing file " + path.string());
+    }
+    const auto read{[&in, &path]() -> std::size_t {
+      std::size_t value;
+      if (!in.read(reinterpret_cast<char*>(&value), sizeof(value))) {
+        throw std::runtime_error("Truncated statistics file " + path.string());
+      }
+      return value;
+    }};
+    Statistics result;
+    result.triples = read();
+    const auto num_predicates{read()};
+    for (std::size_t i{0}; i < num_predicates; i++) {
+      const auto id{read()};
+      auto& stats{result.predicates[id]};
+      stats.triples = read();
+      stats.distinct_subjects = read();
+      stats.distinct_objects = read();
+    }
+    for (auto& histogram: result.occurrence_histograms) {
+      histogram.resize(read());
+      for (auto& count: histogram) {
+        count = read();
+      }
+    }
+    result.characteristic_sets.resize(read());
+    for (auto& set: result.characteristic_sets) {
+      set.subjects = read();
+      set.triples = read();
+      set.predicates.resize(read());
+      for (auto& predicate: set.predicates) {
+        predicate = read();
+      }
+    }
+    return result;
+  }
+}
@@ -0,0 +1,27 @@
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#include <WriteThrottle.hpp>
+
+namespace dldi {
+  WriteThrottle::WriteThrottle(const std::size_t& bytes_per_second)
+    : m_bytes_per_second{bytes_per_second},
+      m_paid_until{std::chrono::steady_clock::now()} {
+    if (bytes_per_second == 0) {
+      throw std::runtime_error("A write throttle needs a positive rate");
+    }
+  }
+
+  auto WriteThrottle::wrote(const std::size_t& bytes) -> void {
+    std::chrono::steady_clock::time_point until;
+    {
+      std::lock_guard lock{m_mutex};
+      // time spent idle isn't saved up for later bursts.
+      m_paid_until = std::max(m_paid_until, std::chrono::steady_clock::now()) +
+                     std::chrono::microseconds{bytes * 1000000 / m_bytes_per_second};
+      until = m_paid_until;
+    }
+    std::this_thread::sleep_until(until);
+  }
+}
@@ -1,11 +1,14 @@
 #include "./cli.hpp"
 
 auto dldi::DldiCli::help_compose() -> void {
-  std::cout << "$ dldi compose [--base-iri <base-IRI>] [--add <path>]* [--subtract <path>]* <output path>\n"
+  std::cout << "$ dldi compose [--base-iri <base-IRI>] [--stable-ids] [--memory-budget <MiB>] [--threads <n>] [--add <path>]* [--subtract <path>]* <output path>\n"
             << "        -h, --help                  This help" << std::endl
             << "        -a, --add <path>            Path to a linked-data resource to include." << std::endl
             << "        -s, --subtract <path>       Path to a linked-data resource to exclude." << std::endl
-            << "        -B, --base-iri <base-IRI>   Base IRI of the dataset." << std::endl;
+            << "        -B, --base-iri <base-IRI>   Base IRI of the dataset." << std::endl
+            << "        -S, --stable-ids            Keep the term IDs of the largest source, instead of reassigning them in lexicographic order." << std::endl
+            << "        -M, --memory-budget <MiB>   Build a plaintext source in runs of about this size, spilled to disk." << std::endl
+            << "        -j, --threads <n>           Number of threads to merge with. Defaults to the number of cores." << std::endl;
 }
 
 
@@ -13,9 +16,12 @@ auto dldi::DldiCli::compose(int argc, char** argv) -> int {
   std::string base_iri;
   std::vector<std::filesystem::path> addition_paths;
   std::vector<std::filesystem::path> subtraction_paths;
+  bool order_preserving_ids{true};
+  std::size_t memory_budget{0};
+  std::size_t num_threads{std::thread::hardware_concurrency()};
 
   int flag{0};
-  while ((flag = getopt(argc, argv, "B:a:s:h")) != -1) {
+  while ((flag = getopt(argc, argv, "B:a:s:SM:j:h")) != -1) {
     switch (flag) {
     case 'a':
       addition_paths.push_back(std::filesystem::canonical(std::filesystem::path{optarg}));
@@ -26,6 +32,15 @@ auto dldi::DldiCli::compose(int argc, char** argv) -> int {
     case 'B':
       base_iri = optarg;
       break;
+    case 'S':
+      order_preserving_ids = false;
+      break;
+    case 'M':
+      memory_budget = std::stoul(optarg) * 1024 * 1024;
+      break;
+    case 'j':
+      num_threads = std::stoul(optarg);
+      break;
     case 'h':
       help_compose();
       return EXIT_SUCCESS;
@@ -48,6 +63,12 @@ auto dldi::DldiCli::compose(int argc, char** argv) -> int {
   }
   const auto output_path{std::filesystem::path{argv[argc - 1]}};
 
-  dldi::DLDI::compose(addition_paths, subtraction_paths, output_path);
+  try {
+    dldi::DLDI::compose(addition_paths, subtraction_paths, output_path, order_preserving_ids, memory_budget, num_threads);
+  } catch (const dldi::UnsortedInput& e) {
+    // only a lone plaintext source is streamed as sorted input.
+    std::cerr << e.what() << ", building " << addition_paths.front() << " like unsorted input instead." << std::endl;
+    dldi::DLDI::from_ptld(addition_paths.front(), output_path, "https://example.com/", memory_budget);
+  }
   return EXIT_SUCCESS;
 }
@@ -1,3 +1,5 @@
+#include <array>
+#include <string_view>
 
 #include "./cli.hpp"
 
@@ -68,15 +70,45 @@ auto dldi::DldiCli::query_triples(int argc, char** argv) -> int {
   const dldi::TriplePattern pattern{subject_id, predicate_id, object_id};
   dldi.prepare_for_query(pattern);
   auto triple_iterator{dldi.query_ptr(pattern)};
+
+  // terms are decoded a batch of triples at a time, into buffers which are reused.
+  constexpr std::size_t batch_size{4096};
+  const std::array<dldi::TripleTermPosition, 3> positions{dldi::TripleTermPosition::subject, dldi::TripleTermPosition::predicate, dldi::TripleTermPosition::object};
+  std::array<std::vector<std::size_t>, 3> ids;
+  std::array<std::string, 3> buffers;
+  std::array<std::vector<std::string_view>, 3> terms;
+  std::string output;
+  const auto write_batch{[&]() {
+    for (std::size_t p{0}; p < positions.size(); p++) {
+      buffers[p].clear();
+      dldi.decode(ids[p], positions[p], buffers[p], terms[p]);
+    }
+    output.clear();
+    for (std::size_t i{0}; i < ids[0].size(); i++) {
+      output.append("<").append(terms[0][i]).append("> <").append(terms[1][i]).append("> ");
+      if (terms[2][i].at(0) == '"') {
+        output.append(terms[2][i]);
+      } else {
+        output.append("<").append(terms[2][i]).append(">");
+      }
+      output.append(" .\n");
+    }
+    std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+    for (auto& position_ids: ids) {
+      position_ids.clear();
+    }
+  }};
   while (triple_iterator->has_next()) {
     const auto triple{triple_iterator->read()};
     triple_iterator->proceed();
-
-    const auto subject_iri{(subject.empty() ? dldi.id_to_string(triple.subject(), dldi::TripleTermPosition::subject) : subject)};
-    const auto predicate_iri{(predicate.empty() ? dldi.id_to_string(triple.predicate(), dldi::TripleTermPosition::predicate) : predicate)};
-    const auto object_base{(object.empty() ? dldi.id_to_string(triple.object(), dldi::TripleTermPosition::object) : object)};
-    const auto object_term{(object_base.at(0) == '"') ? object_base : '<' + object_base + '>'};
-    std::cout << "<" << subject_iri << "> <" << predicate_iri << "> " << object_term << " ." << std::endl;
+    ids[0].push_back(triple.subject());
+    ids[1].push_back(triple.predicate());
+    ids[2].push_back(triple.object());
+    if (ids[0].size() == batch_size) {
+      write_batch();
+    }
   }
+  write_batch();
+  std::cout.flush();
   return EXIT_SUCCESS;
 }
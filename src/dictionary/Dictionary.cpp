@@ -45,6 +45,12 @@ namespace dldi {
   auto Dictionary::id_to_string(const std::size_t& id) const -> std::string {
     return m_trie.id_to_string(id);
   }
+  auto Dictionary::append_string(const std::size_t& id, std::string& buffer) const -> void {
+    m_trie.append_string(id, buffer);
+  }
+  auto Dictionary::decode(std::span<const std::size_t> ids, std::string& buffer, std::vector<std::string_view>& terms) const -> void {
+    m_trie.decode(ids, buffer, terms);
+  }
   auto Dictionary::query(const std::string& prefix) const -> csd::TermStringIterator {
     return m_trie.suggestions(prefix);
   }
@@ -52,6 +58,9 @@ namespace dldi {
     const auto result{m_trie.insert(term, quantity)};
     return result.first;
   }
+  auto Dictionary::merge(const Dictionary& other) -> dldi::IdMapping {
+    return m_trie.merge(other.m_trie);
+  }
   auto Dictionary::remove(const std::string& term, const std::size_t& quantity) -> void {
     const auto id{m_trie.string_to_id(term)};
     if (id == 0) {
@@ -60,25 +69,40 @@ namespace dldi {
     }
     m_trie.remove(id, quantity);
   }
-  auto Dictionary::save(const std::filesystem::path& path) -> void {
+  auto Dictionary::save(const std::filesystem::path& path, bool order_preserving_ids) -> void {
     std::ofstream out{path, std::ios::binary | std::ios::trunc};
     if (!out.good()) {
       throw std::runtime_error("Error opening file `" + path.string() + "`to save dictionary");
     }
-    m_trie.save(out);
+    m_trie.save(out, order_preserving_ids);
     out.close();
   }
+  auto Dictionary::has_order_preserving_ids() const -> bool {
+    return m_trie.hasOrderPreservingIds();
+  }
+  auto Dictionary::lexicographic_ids() const -> dldi::IdMapping {
+    return m_trie.lexicographicIds();
+  }
+  auto Dictionary::occurrence_histogram() const -> std::vector<std::size_t> {
+    return m_trie.occurrenceHistogram();
+  }
+  auto Dictionary::memory_usage() const -> std::size_t {
+    return m_trie.memoryUsage();
+  }
   auto Dictionary::compare(const std::size_t& lhs, const std::size_t& rhs) const -> int {
     return m_trie.compare(lhs, rhs);
   }
 
   auto Dictionary::compare(const std::size_t& lhs, const std::size_t& rhs, const std::shared_ptr<dldi::Dictionary> rhs_dict) const -> int {
-    const auto lhs_tp{csd::TrieAlgorithm::extract_path(m_trie.getData(), lhs - 1)};
-    const auto rhs_tp{csd::TrieAlgorithm::extract_path(rhs_dict->m_trie.getData(), rhs - 1)};
+    const auto lhs_tp{m_trie.get_path(lhs)};
+    const auto rhs_tp{rhs_dict->m_trie.get_path(rhs)};
     return m_trie.compare(lhs, rhs, lhs_tp, rhs_tp, &(rhs_dict->m_trie));
   }
 
   auto Dictionary::size() const -> std::size_t {
     return m_trie.getStats()->numLeaves;
   }
+  auto Dictionary::max_id() const -> std::size_t {
+    return m_trie.maxId();
+  }
 }
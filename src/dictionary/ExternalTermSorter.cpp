@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "./ExternalTermSorter.hpp"
+
+namespace {
+  /**
+   * Terms are stored in run files as their length, their bytes, their ID and their occurrences.
+   */
+  auto write_entry(std::ofstream& out, const dldi::ExternalTermSorter::Entry& entry) -> void {
+    const std::size_t length{entry.term.size()};
+    out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    out.write(entry.term.data(), static_cast<std::streamsize>(length));
+    out.write(reinterpret_cast<const char*>(&entry.id), sizeof(entry.id));
+    out.write(reinterpret_cast<const char*>(&entry.occurrences), sizeof(entry.occurrences));
+  }
+
+  /**
+   * Reads a run file sequentially, an entry at a time.
+   */
+  class RunReader {
+  public:
+    RunReader(const std::filesystem::path& path)
+      : m_in{path, std::ios::binary} {
+      if (!m_in.good()) {
+        throw std::runtime_error("Error opening run file: " + path.string());
+      }
+      proceed();
+    }
+    auto has_next() const -> bool {
+      return m_has_next;
+    }
+    auto read() const -> const dldi::ExternalTermSorter::Entry& {
+      return m_next;
+    }
+    auto proceed() -> void {
+      std::size_t length{0};
+      m_has_next = static_cast<bool>(m_in.read(reinterpret_cast<char*>(&length), sizeof(length)));
+      if (m_has_next) {
+        m_next.term.resize(length);
+        m_in.read(m_next.term.data(), static_cast<std::streamsize>(length));
+        m_in.read(reinterpret_cast<char*>(&m_next.id), sizeof(m_next.id));
+        m_in.read(reinterpret_cast<char*>(&m_next.occurrences), sizeof(m_next.occurrences));
+        if (!m_in) {
+          throw std::runtime_error("Truncated run file of terms");
+        }
+      }
+    }
+
+  private:
+    std::ifstream m_in;
+    bool m_has_next{false};
+    dldi::ExternalTermSorter::Entry m_next{};
+  };
+
+  inline auto follows(const std::unique_ptr<RunReader>& lhs, const std::unique_ptr<RunReader>& rhs) -> bool {
+    return rhs->read().term < lhs->read().term;
+  }
+
+  inline auto precedes(const dldi::ExternalTermSorter::Entry& lhs, const dldi::ExternalTermSorter::Entry& rhs) -> bool {
+    return lhs.term < rhs.term;
+  }
+
+  // what malloc adds to every allocation.
+  constexpr std::size_t ALLOCATION_OVERHEAD{16};
+}
+
+namespace dldi {
+  ExternalTermSorter::ExternalTermSorter(const std::filesystem::path& runs_dir, const std::string& name, const std::size_t& memory_budget)
+    : m_runs_dir{runs_dir},
+      m_name{name},
+      m_memory_budget{memory_budget} {
+  }
+
+  auto ExternalTermSorter::add(const std::string& term, const std::size_t& id, const std::size_t& occurrences) -> void {
+    m_buffer.push_back(Entry{term, id, occurrences});
+    if (m_buffer.back().term.capacity() > std::string{}.capacity()) {
+      m_term_bytes += m_buffer.back().term.capacity() + 1 + ALLOCATION_OVERHEAD;
+    }
+    if (m_memory_budget > 0 && m_buffer.capacity() * sizeof(Entry) + m_term_bytes >= m_memory_budget) {
+      spill();
+    }
+  }
+
+  auto ExternalTermSorter::spill() -> void {
+    std::filesystem::create_directories(m_runs_dir);
+    const auto run_path{m_runs_dir / (m_name + "-" + std::to_string(m_runs.size()))};
+    std::ofstream out{run_path, std::ios::binary | std::ios::trunc};
+    if (!out.good()) {
+      throw std::runtime_error("Error opening run file: " + run_path.string());
+    }
+    std::sort(m_buffer.begin(), m_buffer.end(), precedes);
+    for (const auto& entry: m_buffer) {
+      write_entry(out, entry);
+    }
+    if (!out.flush()) {
+      throw std::runtime_error("Failed to write " + run_path.string());
+    }
+    m_runs.push_back(run_path);
+    m_buffer = std::vector<Entry>{};
+    m_term_bytes = 0;
+  }
+
+  auto ExternalTermSorter::for_each(const std::function<void(const std::string& term, const std::size_t& id, const std::size_t& occurrences)>& callback) -> void {
+    if (m_runs.empty()) {
+      std::sort(m_buffer.begin(), m_buffer.end(), precedes);
+      for (const auto& entry: m_buffer) {
+        callback(entry.term, entry.id, entry.occurrences);
+      }
+    } else {
+      if (!m_buffer.empty()) {
+        spill();
+      }
+      std::vector<std::unique_ptr<RunReader>> heap;
+      for (const auto& run: m_runs) {
+        auto reader{std::make_unique<RunReader>(run)};
+        if (reader->has_next()) {
+          heap.push_back(std::move(reader));
+        }
+      }
+      std::make_heap(heap.begin(), heap.end(), follows);
+      while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), follows);
+        auto& reader{heap.back()};
+        const auto& entry{reader->read()};
+        callback(entry.term, entry.id, entry.occurrences);
+        reader->proceed();
+        if (reader->has_next()) {
+          std::push_heap(heap.begin(), heap.end(), follows);
+        } else {
+          heap.pop_back();
+        }
+      }
+      for (const auto& run: m_runs) {
+        std::filesystem::remove(run);
+      }
+      m_runs.clear();
+    }
+    m_buffer = std::vector<Entry>{};
+    m_term_bytes = 0;
+  }
+}
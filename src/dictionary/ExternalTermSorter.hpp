@@ -0,0 +1,50 @@
+#ifndef DLDI_EXTERNAL_TERM_SORTER_HPP
+#define DLDI_EXTERNAL_TERM_SORTER_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace dldi {
+
+  /**
+   * Sorts terms, each with an ID and a number of occurrences, with bounded memory.
+   * Whenever the buffered terms exceed the budget, they are sorted and spilled to a run file,
+   * and the runs are merged when the terms are read back.
+   */
+  class ExternalTermSorter {
+  public:
+    /**
+     * A `memory_budget` of 0 keeps all terms in memory.
+     */
+    ExternalTermSorter(const std::filesystem::path& runs_dir, const std::string& name, const std::size_t& memory_budget = 0);
+    auto add(const std::string& term, const std::size_t& id, const std::size_t& occurrences) -> void;
+    /**
+     * Pass all terms to `callback` in lexicographic order, and remove the run files.
+     * Equal terms are passed one after another, in no particular order of their IDs.
+     */
+    auto for_each(const std::function<void(const std::string& term, const std::size_t& id, const std::size_t& occurrences)>& callback) -> void;
+
+    struct Entry {
+      std::string term;
+      std::size_t id;
+      std::size_t occurrences;
+    };
+
+  private:
+    auto spill() -> void;
+    std::filesystem::path m_runs_dir;
+    std::string m_name;
+    std::size_t m_memory_budget;
+    std::vector<Entry> m_buffer;
+    /**
+     * Bytes allocated by the buffered terms which are too long to be stored in place.
+     */
+    std::size_t m_term_bytes{0};
+    std::vector<std::filesystem::path> m_runs;
+  };
+}
+
+#endif
@@ -0,0 +1,46 @@
+#include "./TermEncodingCache.hpp"
+
+namespace {
+  // what malloc adds to every allocation.
+  constexpr std::size_t ALLOCATION_OVERHEAD{16};
+}
+
+namespace dldi {
+  TermEncodingCache::TermEncodingCache(Dictionary& dictionary, const std::size_t& capacity)
+    : m_dictionary{&dictionary},
+      m_capacity{capacity} {
+  }
+
+  auto TermEncodingCache::add(const std::string& term) -> std::size_t {
+    const auto entry{m_entries.find(term)};
+    if (entry != m_entries.end()) {
+      entry->second.pending++;
+      return entry->second.id;
+    }
+    if (m_entries.size() >= m_capacity) {
+      flush();
+    }
+    const auto id{m_dictionary->add(term, 1)};
+    const auto inserted{m_entries.emplace(term, Entry{id, 0}).first};
+    if (inserted->first.capacity() > std::string{}.capacity()) {
+      m_term_bytes += inserted->first.capacity() + 1 + ALLOCATION_OVERHEAD;
+    }
+    return id;
+  }
+
+  auto TermEncodingCache::flush() -> void {
+    for (const auto& [term, entry]: m_entries) {
+      if (entry.pending > 0) {
+        m_dictionary->add(term, entry.pending);
+      }
+    }
+    m_entries.clear();
+    m_term_bytes = 0;
+  }
+
+  auto TermEncodingCache::memory_usage() const -> std::size_t {
+    // a node holds the next pointer, the entry and the cached hash.
+    constexpr std::size_t NODE_SIZE{sizeof(void*) + sizeof(std::pair<const std::string, Entry>) + sizeof(std::size_t) + ALLOCATION_OVERHEAD};
+    return m_entries.bucket_count() * sizeof(void*) + m_entries.size() * NODE_SIZE + m_term_bytes;
+  }
+}
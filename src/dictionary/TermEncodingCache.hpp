@@ -0,0 +1,48 @@
+#ifndef DLDI_TERM_ENCODING_CACHE_HPP
+#define DLDI_TERM_ENCODING_CACHE_HPP
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+#include <dictionary/Dictionary.hpp>
+
+namespace dldi {
+  /**
+   * A bounded cache from terms to their IDs in front of `Dictionary::add`, for bulk loading. 
+   * Repeated terms are counted in the cache, and their counts are added to the dictionary 
+   * when the cache fills up or is flushed. 
+   * The dictionary's quantities are only complete after `flush`. 
+  */
+  class TermEncodingCache {
+  public:
+    TermEncodingCache(Dictionary& dictionary, const std::size_t& capacity = 1 << 20);
+    /**
+     * Add one occurrence of the term, and return its ID. 
+    */
+    auto add(const std::string& term) -> std::size_t;
+    auto flush() -> void;
+    /**
+     * An estimate of the heap memory of the cached terms, including the hash table's overhead. 
+    */
+    auto memory_usage() const -> std::size_t;
+
+  private:
+    struct Entry {
+      std::size_t id;
+      /**
+       * Occurrences which are not yet added to the dictionary. 
+      */
+      std::size_t pending;
+    };
+    Dictionary* m_dictionary;
+    std::size_t m_capacity;
+    std::unordered_map<std::string, Entry> m_entries;
+    /**
+     * Bytes allocated by the cached terms which are too long to be stored in place.
+    */
+    std::size_t m_term_bytes{0};
+  };
+}
+
+#endif
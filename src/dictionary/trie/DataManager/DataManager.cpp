@@ -41,14 +41,17 @@ namespace csd {
           .ptr{nullptr},
           .length{0}},
         .outEdgeIds{
+          .ptr{nullptr},
+          .length{0}},
+        .outEdgeFirstBytes{
           .ptr{nullptr},
           .length{0}}},
       m_outEdgesMap{std::make_unique<std::unordered_map<std::size_t, NewOutEdgesList>>()},
-      m_loadTimeLeafHoles{std::vector<csd::Hole>()},
-      m_finalLeafHoles{std::vector<csd::Hole>()},
+      m_bufferLabelBytes{0},
       m_numNewLeafNodeDeletions{0},
+      m_numBufferLeafNodeDeletions{0},
       m_numInternalNodeDeletions{0},
-      m_leafHolesComputed{false} {
+      m_orderPreservingIds{false} {
   }
   DataManager::~DataManager() {
     for (std::size_t i = 0; i < m_buffers.edges.length; i++) {
@@ -62,6 +65,22 @@ namespace csd {
   auto DataManager::getStats() const -> const TrieStats* const {
     return &m_stats;
   }
+  auto DataManager::memoryUsage() const -> std::size_t {
+    // what malloc adds to every allocation.
+    constexpr std::size_t ALLOCATION_OVERHEAD{16};
+    // an out-edge list is a map node (next pointer, key and shared pointer), and the vector it shares, with its reference counts.
+    constexpr std::size_t OUT_EDGE_LIST_OVERHEAD{4 * sizeof(void*) + 2 * ALLOCATION_OVERHEAD + sizeof(std::vector<std::size_t>) + 2 * sizeof(long)};
+    return m_buffers.leaves.capacity * sizeof(LeafNode) +
+           m_buffers.internals.capacity * sizeof(InternalNode) +
+           m_buffers.edges.capacity * sizeof(Edge) +
+           m_buffers.labels.capacity * sizeof(unsigned char*) +
+           // each label is allocated on its own.
+           m_bufferLabelBytes + m_buffers.labels.length * ALLOCATION_OVERHEAD +
+           m_outEdgesMap->bucket_count() * sizeof(void*) +
+           m_outEdgesMap->size() * OUT_EDGE_LIST_OVERHEAD +
+           // new edges are in the out-edge list of their node, whose vector may have room for twice its edges.
+           m_buffers.edges.length * 2 * sizeof(std::size_t);
+  }
   auto DataManager::getMmapPointers() const -> const MmapPointers* const {
     return &m_mmapPointers;
   }
@@ -6,11 +6,14 @@
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include <dictionary/trie/DataTypes.hpp>
 #include <dictionary/trie/Trie.hpp>
 
+#include "../RankSelectBitvector.hpp"
+
 namespace csd {
 
   struct Hole {
@@ -19,6 +22,28 @@ namespace csd {
     // hacky field added late
     std::size_t cumulative;
   };
+  /**
+   * A saved dictionary starts with this word ("DLDIDICT"), followed by the version of its layout.
+   * Files saved before there was a version start with the number of leaves, and have no flags.
+   */
+  constexpr std::size_t DICTIONARY_MAGIC{0x5443494449444c44};
+  constexpr std::size_t DICTIONARY_VERSION{1};
+
+  /**
+   * Bits of the `flags` field in the header of a saved dictionary.
+   */
+  enum DictionaryFlags : std::size_t {
+    OrderPreservingIds = 1,
+    /**
+     * The leaf nodes are followed by a rank/select bitvector of their exposed IDs, which have gaps.
+     */
+    LeafIdBitvector = 2,
+    /**
+     * The internal nodes are followed by the first label byte of each out-edge, in the order of the out-edge IDs.
+     */
+    OutEdgeFirstBytes = 4
+  };
+
   template <class T>
   struct TrieBuffer {
     T* buf;
@@ -46,6 +71,8 @@ namespace csd {
     struct TypedMmapPointer<Edge> edges;
     struct TypedMmapPointer<unsigned char> labels;
     struct TypedMmapPointer<std::size_t> outEdgeIds;
+    // empty for files saved without them
+    struct TypedMmapPointer<unsigned char> outEdgeFirstBytes;
   };
 
   class DataManager {
@@ -53,7 +80,11 @@ namespace csd {
     DataManager();
     ~DataManager();
 
-    auto save(std::ostream& fp) -> void;
+    /**
+     * When `orderPreservingIds` is set, leaf nodes are written in lexicographic order,
+     * so that comparing two exposed IDs is equivalent to comparing their terms.
+     */
+    auto save(std::ostream& fp, bool orderPreservingIds) -> void;
     auto load(unsigned char* ptr) -> void;
 
     // Edges
@@ -78,12 +109,37 @@ namespace csd {
     [[nodiscard]] auto get_leafNode(const std::size_t& nodeId, bool dontThrowOnNotFound = false) const -> LeafNode* const;
     [[nodiscard]] auto internalToExposedId(const std::size_t& internalId) const -> std::size_t;
     [[nodiscard]] auto exposedToInternalId(const std::size_t& realId) const -> std::size_t;
+    /**
+     * The largest exposed ID of any leaf, which may exceed the number of leaves when IDs have gaps.
+     */
+    [[nodiscard]] auto maxExposedId() const -> std::size_t;
+
+    /**
+     * Whether exposed IDs are ordered like the terms they represent.
+     * Only holds for data loaded from an order-preserving save, until new leaves are added.
+     */
+    [[nodiscard]] auto hasOrderPreservingIds() const -> bool;
+    /**
+     * Maps each current exposed ID to the exposed ID it will have after an order-preserving save.
+     * Index 0, and the indexes of deleted leaves, map to 0.
+     */
+    [[nodiscard]] auto lexicographicIds() const -> std::vector<std::size_t>;
+    /**
+     * The number of terms by the binary logarithm of their occurrences:
+     * entry k counts the terms with [2^k, 2^(k+1)) occurrences.
+     */
+    [[nodiscard]] auto occurrenceHistogram() const -> std::vector<std::size_t>;
 
     // Out-edges
 
     auto add_outEdge(const std::size_t& nodeId, const std::size_t& edgeId) const -> void;
     auto remove_outedge(const std::size_t& nodeId, const std::size_t& edgeId) const -> void;
     [[nodiscard]] auto getNewOutEdges(const std::size_t& nodeId) const -> NewOutEdgesList;
+    /**
+     * The out-edge of a node whose label starts with the given byte, if any.
+     * Out-edges of a node start with distinct bytes, so there is at most one.
+     */
+    [[nodiscard]] auto findOutEdge(const std::size_t& nodeId, const unsigned char& firstByte) const -> std::optional<std::size_t>;
 
     // Labels
 
@@ -93,6 +149,10 @@ namespace csd {
     // Statistics
 
     [[nodiscard]] auto getStats() const -> const TrieStats* const;
+    /**
+     * An estimate of the heap memory of the data added since loading, including allocator overhead.
+     */
+    [[nodiscard]] auto memoryUsage() const -> std::size_t;
 
     [[nodiscard]] auto getMmapPointers() const -> const MmapPointers* const;
 
@@ -101,12 +161,24 @@ namespace csd {
     TrieBuffers m_buffers;
     MmapPointers m_mmapPointers;
     std::unique_ptr<std::unordered_map<std::size_t, NewOutEdgesList>> m_outEdgesMap;
-    std::vector<csd::Hole> m_loadTimeLeafHoles;
-    std::vector<csd::Hole> m_finalLeafHoles;
+    /**
+     * The bytes allocated for the labels of the edges in the buffers.
+     */
+    std::size_t m_bufferLabelBytes;
+    /**
+     * The exposed IDs (less one) of the loaded leaves, for when leaves were removed before saving without renumbering.
+     * Empty if exposed IDs are simply internal IDs plus one.
+     * Leaves added since loading carry on after the last bit.
+     */
+    RankSelectBitvector m_leafIds;
     std::size_t m_numNewLeafNodeDeletions;
+    /**
+     * Deletions of leaf nodes which were added since loading.
+     * Only an order-preserving save, which renumbers all leaves, can leave them out.
+     */
+    std::size_t m_numBufferLeafNodeDeletions;
     std::size_t m_numInternalNodeDeletions;
-    bool m_leafHolesComputed;
-    auto computeLeafHoles() -> void;
+    bool m_orderPreservingIds;
   };
 }
 
@@ -23,6 +23,7 @@ namespace csd {
     possibly_realloc(&m_buffers.labels);
     m_buffers.labels.buf[bufferIndex] = static_cast<unsigned char*>(malloc(until - from));
     m_buffers.labels.length++;
+    m_bufferLabelBytes += until - from;
     std::memcpy(m_buffers.labels.buf[bufferIndex], rdfTerm + from, until - from);
     m_stats.numEdges++;
     m_stats.numLabelBytes += (until - from);
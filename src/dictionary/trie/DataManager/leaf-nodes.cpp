@@ -1,6 +1,8 @@
+#include <bit>
 #include <stdexcept>
 
 #include <dictionary/trie/DataTypes.hpp>
+#include <dictionary/trie/TermIterator.hpp>
 
 #include "DataManager.hpp"
 #include "utils.hpp"
@@ -18,16 +20,12 @@ namespace csd {
   }
 
   auto DataManager::remove_leafNode(const std::size_t& nodeId) -> void {
-    if (nodeId >= m_mmapPointers.leaves.length) {
-      /**
-       * @brief We forbid removing statements (and by consequence, also terms) 
-       * that aren't already present in the DLDI. 
-       * Therefore, it's only possible to leaf nodes in the mmapped area. 
-       */
-      throw std::runtime_error("Tried to remove term not present in original DLDI");
-    }
     get_leafNode(nodeId)->occurences = 0;
     m_stats.numLeaves--;
+    if (nodeId >= m_mmapPointers.leaves.length) {
+      m_numBufferLeafNodeDeletions++;
+      return;
+    }
     m_numNewLeafNodeDeletions++;
   }
   auto DataManager::get_leafNode(const std::size_t& nodeId, bool dontThrowOnNotFound) const -> LeafNode* const {
@@ -38,30 +36,33 @@ namespace csd {
     return n;
   }
 
-  auto DataManager::internalToExposedId(const std::size_t& internalId) const -> std::size_t {
-    if (m_loadTimeLeafHoles.empty()) {
+  /**
+   * The exposed ID of a leaf, given the holes which older files list.
+   */
+  static auto holeAdjustedId(const std::vector<csd::Hole>& holes, const std::size_t& internalId) -> std::size_t {
+    if (holes.empty()) {
       return internalId + 1;
     }
 
-    std::size_t searchMax{m_loadTimeLeafHoles.size() - 1};
+    std::size_t searchMax{holes.size() - 1};
     std::size_t searchMin{0};
     std::size_t i{(searchMax - searchMin) / 2};
 
     while (true) {
-      const auto* const hole{&m_loadTimeLeafHoles.at(i)};
+      const auto* const hole{&holes.at(i)};
 
       if (internalId < hole->start) {
         if (i == 0) {
           return internalId + 1;
         }
-        if (m_loadTimeLeafHoles.at(i - 1).start < internalId) {
+        if (holes.at(i - 1).start < internalId) {
           // id is between the previous hole and this one
-          return internalId + m_loadTimeLeafHoles.at(i - 1).cumulative + 1;
+          return internalId + holes.at(i - 1).cumulative + 1;
         }
         // id is smaller, cut search space in half. go to the left.
         searchMax = i - 1;
       } else {
-        if ((i == m_loadTimeLeafHoles.size() - 1) || (m_loadTimeLeafHoles.at(i + 1).start > internalId)) {
+        if ((i == holes.size() - 1) || (holes.at(i + 1).start > internalId)) {
           // id is between this and the next hole
           return internalId + hole->cumulative + 1;
         }
@@ -71,37 +72,78 @@ namespace csd {
     }
   }
 
+  auto leafIdBitvector(const std::vector<csd::Hole>& holes, const std::size_t& numLeaves) -> RankSelectBitvector {
+    if (holes.empty()) {
+      return RankSelectBitvector{};
+    }
+    std::vector<std::size_t> positions;
+    positions.reserve(numLeaves);
+    for (std::size_t i{0}; i < numLeaves; i++) {
+      positions.push_back(holeAdjustedId(holes, i) - 1);
+    }
+    // leaves added after the last one carry on from the exposed ID it would have.
+    return RankSelectBitvector::fromPositions(positions, holeAdjustedId(holes, numLeaves) - 1);
+  }
+
+  auto DataManager::internalToExposedId(const std::size_t& internalId) const -> std::size_t {
+    if (m_leafIds.empty()) {
+      return internalId + 1;
+    }
+    if (internalId < m_leafIds.numOnes()) {
+      return m_leafIds.select(internalId) + 1;
+    }
+    return m_leafIds.size() + (internalId - m_leafIds.numOnes()) + 1;
+  }
+
+  auto DataManager::maxExposedId() const -> std::size_t {
+    const auto numLeafIds{m_mmapPointers.leaves.length + m_buffers.leaves.length};
+    return numLeafIds == 0 ? 0 : internalToExposedId(numLeafIds - 1);
+  }
+
   auto DataManager::exposedToInternalId(const std::size_t& exposedId) const -> std::size_t {
-    if (m_loadTimeLeafHoles.empty()) {
+    if (m_leafIds.empty()) {
       return exposedId - 1;
     }
+    if (exposedId <= m_leafIds.size()) {
+      return m_leafIds.rank(exposedId - 1);
+    }
+    return m_leafIds.numOnes() + (exposedId - m_leafIds.size()) - 1;
+  }
 
-    std::size_t searchMax{m_loadTimeLeafHoles.size() - 1};
-    std::size_t searchMin{0};
-    std::size_t i{(searchMax - searchMin) / 2};
+  auto DataManager::hasOrderPreservingIds() const -> bool {
+    // leaves added since loading are appended, regardless of where their terms sort.
+    return m_orderPreservingIds && m_buffers.leaves.length == 0;
+  }
 
-    while (true) {
-      const auto* const curr{&m_loadTimeLeafHoles.at(i)};
-      const auto currFirst = curr->start + 1 + ((i > 0) ? (&m_loadTimeLeafHoles.at(i - 1))->cumulative : 0);
-      if (exposedId < currFirst) {
-        if (i == 0) {
-          // no holes apply
-          return exposedId - 1;
-        }
-        const auto* const prev{&m_loadTimeLeafHoles.at(i - 1)};
-        const auto prevLast{prev->start + prev->size - 1 + prev->cumulative + 1};
-        if (exposedId > prevLast) {
-          // between this and the previous hole
-          return exposedId - (&m_loadTimeLeafHoles.at(i - 1))->cumulative - 1;
-        }
-        searchMax = i - 1;
-      } else {
-        if (i == m_loadTimeLeafHoles.size() - 1 || (exposedId < (&m_loadTimeLeafHoles.at(i + 1))->start + curr->cumulative + 1)) {
-          return exposedId - curr->cumulative - 1;
-        }
-        searchMin = i + 1;
+  auto DataManager::lexicographicIds() const -> std::vector<std::size_t> {
+    const auto numLeafIds{m_mmapPointers.leaves.length + m_buffers.leaves.length};
+    if (numLeafIds == 0) {
+      return std::vector<std::size_t>(1, 0);
+    }
+    std::vector<std::size_t> ids(internalToExposedId(numLeafIds - 1) + 1, 0);
+    std::size_t rank{0};
+    auto it{TermIterator(this, "")};
+    while (it.has_next()) {
+      ids.at(internalToExposedId(it.read())) = ++rank;
+      it.proceed();
+    }
+    return ids;
+  }
+
+  auto DataManager::occurrenceHistogram() const -> std::vector<std::size_t> {
+    std::vector<std::size_t> histogram;
+    const auto numLeafIds{m_mmapPointers.leaves.length + m_buffers.leaves.length};
+    for (std::size_t i{0}; i < numLeafIds; i++) {
+      const auto occurrences{get_leafNode(i, true)->occurences};
+      if (occurrences == 0) {
+        continue;
       }
-      i = searchMax - (searchMax - searchMin) / 2;
+      const auto bucket{static_cast<std::size_t>(std::bit_width(occurrences) - 1)};
+      if (histogram.size() <= bucket) {
+        histogram.resize(bucket + 1, 0);
+      }
+      histogram[bucket]++;
     }
+    return histogram;
   }
 }
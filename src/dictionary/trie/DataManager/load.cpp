@@ -1,14 +1,27 @@
 #include <cstddef>
+#include <stdexcept>
+#include <string>
 
 #include <dictionary/trie/DataTypes.hpp>
 
 #include "DataManager.hpp"
+#include "utils.hpp"
 
 #define INITIAL_CAPCITY 1
 
 namespace csd {
 
   auto DataManager::load(unsigned char* ptr) -> void {
+    const bool versioned{*reinterpret_cast<const std::size_t* const>(ptr) == DICTIONARY_MAGIC};
+    if (versioned) {
+      ptr += sizeof(std::size_t);
+      const auto version = *reinterpret_cast<const std::size_t* const>(ptr);
+      if (version != DICTIONARY_VERSION) {
+        throw std::runtime_error("Unsupported dictionary version " + std::to_string(version) + ", expected " + std::to_string(DICTIONARY_VERSION));
+      }
+      ptr += sizeof(std::size_t);
+    }
+
     m_mmapPointers.leaves.length = *reinterpret_cast<const std::size_t* const>(ptr);
     ptr += sizeof(std::size_t);
 
@@ -25,6 +38,13 @@ namespace csd {
     const auto num_leaf_holes = *reinterpret_cast<const std::size_t* const>(ptr);
     ptr += sizeof(std::size_t);
 
+    std::size_t flags{0};
+    if (versioned) {
+      flags = *reinterpret_cast<const std::size_t* const>(ptr);
+      ptr += sizeof(std::size_t);
+    }
+    m_orderPreservingIds = (flags & DictionaryFlags::OrderPreservingIds) != 0;
+
     m_stats.numLeaves = m_mmapPointers.leaves.length;
     m_stats.numInternalNodes = m_mmapPointers.internals.length;
     m_stats.numEdges = m_mmapPointers.edges.length;
@@ -42,13 +62,24 @@ namespace csd {
     auto* nodeHolesPtr{ptr};
     ptr += sizeof(struct Hole) * num_leaf_holes;
 
+    if ((flags & DictionaryFlags::LeafIdBitvector) != 0) {
+      ptr = const_cast<unsigned char*>(m_leafIds.load(ptr));
+    }
+
     m_mmapPointers.outEdgeIds.ptr = reinterpret_cast<std::size_t* const>(ptr);
     ptr += m_stats.numEdges * sizeof(std::size_t);
 
     m_mmapPointers.internals.ptr = reinterpret_cast<InternalNode* const>(ptr);
     ptr += sizeof(struct InternalNode) * m_stats.numInternalNodes;
 
-    m_loadTimeLeafHoles.reserve(num_leaf_holes);
+    if ((flags & DictionaryFlags::OutEdgeFirstBytes) != 0) {
+      m_mmapPointers.outEdgeFirstBytes.ptr = ptr;
+      m_mmapPointers.outEdgeFirstBytes.length = m_stats.numEdges;
+      ptr += m_stats.numEdges;
+    }
+
+    std::vector<csd::Hole> leafHoles;
+    leafHoles.reserve(num_leaf_holes);
     for (std::size_t i = 0; i < num_leaf_holes; i++) {
       const auto* const h = reinterpret_cast<const struct Hole*>(nodeHolesPtr + i * sizeof(std::size_t) * 3);
       struct Hole newHole {
@@ -56,7 +87,11 @@ namespace csd {
         .size = h->size,
         .cumulative = h->cumulative
       };
-      m_loadTimeLeafHoles.push_back(newHole);
+      leafHoles.push_back(newHole);
+    }
+    if (!leafHoles.empty()) {
+      // saved before the bitvector was.
+      m_leafIds = leafIdBitvector(leafHoles, m_stats.numLeaves);
     }
   }
 }
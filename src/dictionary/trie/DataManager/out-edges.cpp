@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <stdexcept>
 
 #include "DataManager.hpp"
@@ -50,4 +51,41 @@ namespace csd {
     }
     return m_outEdgesMap->at(nodeId);
   }
+
+  auto DataManager::findOutEdge(const std::size_t& nodeId, const unsigned char& firstByte) const -> std::optional<std::size_t> {
+    if (nodeId < m_mmapPointers.internals.length) {
+      const auto begin{get_internalNode(nodeId, true)->outEdgesOffset};
+      const auto end{nodeId + 1 == m_mmapPointers.internals.length ? m_mmapPointers.outEdgeIds.length : get_internalNode(nodeId + 1, true)->outEdgesOffset};
+      if (m_mmapPointers.outEdgeFirstBytes.length > 0) {
+        const auto* const bytes{m_mmapPointers.outEdgeFirstBytes.ptr};
+        const auto* const found{std::lower_bound(bytes + begin, bytes + end, firstByte)};
+        if (found != bytes + end && *found == firstByte) {
+          const auto edgeId{m_mmapPointers.outEdgeIds.ptr[found - bytes]};
+          // otherwise, an edge with the same first byte may have been added since.
+          if (edge_exists(edgeId)) {
+            return edgeId;
+          }
+        }
+      } else {
+        for (auto i{begin}; i < end; i++) {
+          const auto edgeId{m_mmapPointers.outEdgeIds.ptr[i]};
+          if (edge_exists(edgeId) && get_label(edgeId)[0] == firstByte) {
+            return edgeId;
+          }
+        }
+      }
+    }
+    const auto newEdges{getNewOutEdges(nodeId)};
+    if (newEdges == nullptr) {
+      return std::nullopt;
+    }
+    // kept in order of their first bytes by `add_outEdge`.
+    const auto found{std::ranges::lower_bound(*newEdges, firstByte, {}, [this](const std::size_t& edgeId) {
+      return get_label(edgeId)[0];
+    })};
+    if (found != newEdges->end() && get_label(*found)[0] == firstByte) {
+      return *found;
+    }
+    return std::nullopt;
+  }
 }
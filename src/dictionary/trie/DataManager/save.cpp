@@ -1,6 +1,7 @@
 #include <stdexcept>
 
 #include <dictionary/trie/OutEdgeIterator.hpp>
+#include <dictionary/trie/TermIterator.hpp>
 
 #include "DataManager.hpp"
 #include "utils.hpp"
@@ -57,98 +58,55 @@ auto get_new_id(std::size_t id, const std::vector<csd::Hole>& holes) -> std::siz
 
 namespace csd {
 
-  auto DataManager::computeLeafHoles() -> void {
-    m_leafHolesComputed = true;
-
-    std::size_t realId{0};
-    std::size_t holeIndex{0};
-
-    std::size_t numAppliedLeafNodeDeletions{0};
-    for (std::size_t localId{0}; localId < m_mmapPointers.leaves.length && numAppliedLeafNodeDeletions < m_numNewLeafNodeDeletions; localId++) {
-      const bool nodeIsDeleted{get_leafNode(localId, true)->occurences == 0};
-      if (!nodeIsDeleted) {
-        realId++;
-        continue;
-      }
-      numAppliedLeafNodeDeletions++;
-      while (holeIndex < m_loadTimeLeafHoles.size() && m_loadTimeLeafHoles.at(holeIndex).start + m_loadTimeLeafHoles.at(holeIndex).size < realId) {
-        realId += m_loadTimeLeafHoles.at(holeIndex).size;
-        m_finalLeafHoles.push_back(m_loadTimeLeafHoles.at(holeIndex));
-        m_finalLeafHoles.at(m_finalLeafHoles.size() - 1).cumulative = (realId - localId);
-        holeIndex++;
-      }
-
-      auto* hole{(m_loadTimeLeafHoles.empty() || m_loadTimeLeafHoles.size() <= holeIndex) ? nullptr : &m_loadTimeLeafHoles.at(holeIndex)};
-
-      if (hole != nullptr && realId == hole->start - 1) {
-        // expand left
-        const Hole newHole{
-          .start = hole->start - 1,
-          .size = hole->size + 1,
-          .cumulative = (m_finalLeafHoles.empty() ? 0 : m_finalLeafHoles.at(m_finalLeafHoles.size() - 1).cumulative) + hole->size + 1};
-        m_finalLeafHoles.push_back(newHole);
-        realId += newHole.size;
-        continue;
-      }
-
-      if (!m_finalLeafHoles.empty() && m_finalLeafHoles.at(m_finalLeafHoles.size() - 1).start + m_finalLeafHoles.at(m_finalLeafHoles.size() - 1).size == realId) {
-        m_finalLeafHoles.at(m_finalLeafHoles.size() - 1).size++;
-        m_finalLeafHoles.at(m_finalLeafHoles.size() - 1).cumulative++;
-        realId++;
-        continue;
+  auto DataManager::save(std::ostream& fp, bool orderPreservingIds) -> void {
+    // With order-preserving IDs, leaf nodes are written in the order a depth-first traversal visits them.
+    // No holes are left behind, so the saved leaf IDs are exactly the lexicographic ranks.
+    std::vector<std::size_t> lexicographicLeaves;
+    std::vector<std::size_t> lexicographicRanks;
+    if (orderPreservingIds) {
+      lexicographicRanks.resize(m_mmapPointers.leaves.length + m_buffers.leaves.length);
+      lexicographicLeaves.reserve(m_stats.numLeaves);
+      auto it{TermIterator(this, "")};
+      while (it.has_next()) {
+        lexicographicRanks.at(it.read()) = lexicographicLeaves.size();
+        lexicographicLeaves.push_back(it.read());
+        it.proceed();
       }
-
-      if (hole != nullptr && realId == hole->start + hole->size) {
-        // expand right
-
-        const Hole newHole{
-          .start = hole->start,
-          .size = hole->size + 1,
-          .cumulative = (m_finalLeafHoles.empty() ? 0 : m_finalLeafHoles.at(m_finalLeafHoles.size() - 1).cumulative) + hole->size + 1};
-        m_finalLeafHoles.push_back(newHole);
-        realId++;
-        continue;
-      }
-
-      if (!m_finalLeafHoles.empty() && realId == m_finalLeafHoles.at(m_finalLeafHoles.size() - 1).start + m_finalLeafHoles.at(m_finalLeafHoles.size() - 1).size) {
-        m_finalLeafHoles.at(m_finalLeafHoles.size() - 1).size++;
-        m_finalLeafHoles.at(m_finalLeafHoles.size() - 1).cumulative++;
-        realId++;
-        continue;
-      }
-
-      if (hole == nullptr || realId < hole->start) {
-        // new hole
-        const Hole newHole{
-          .start = realId,
-          .size = 1,
-          .cumulative = (m_finalLeafHoles.empty() ? 0 : m_finalLeafHoles.at(m_finalLeafHoles.size() - 1).cumulative) + 1};
-        m_finalLeafHoles.push_back(newHole);
-        realId++;
+    } else {
+      if (m_numBufferLeafNodeDeletions > 0) {
+        throw std::runtime_error("Terms added since loading were removed again, which requires saving with order-preserving IDs");
       }
     }
-
-    while (holeIndex < m_loadTimeLeafHoles.size()) {
-      auto hole{m_loadTimeLeafHoles.at(holeIndex)};
-      const auto cumulative{(m_finalLeafHoles.empty() ? 0 : m_finalLeafHoles.at(m_finalLeafHoles.size() - 1).cumulative) + hole.size};
-      const Hole newHole{
-        .start = hole.start,
-        .size = hole.size,
-        .cumulative = cumulative};
-      m_finalLeafHoles.push_back(newHole);
-      holeIndex++;
-    }
-  }
-  auto DataManager::save(std::ostream& fp) -> void {
-    if (!m_leafHolesComputed) {
-      computeLeafHoles();
+    // Without renumbering, the exposed IDs of the remaining leaves are kept as they are, gaps and all.
+    RankSelectBitvector leafIds;
+    if (!orderPreservingIds && (!m_leafIds.empty() || m_numNewLeafNodeDeletions > 0)) {
+      const auto numLeafIds{m_mmapPointers.leaves.length + m_buffers.leaves.length};
+      std::vector<std::size_t> positions;
+      positions.reserve(m_stats.numLeaves);
+      for (std::size_t i{0}; i < numLeafIds; i++) {
+        if (get_leafNode(i, true)->occurences > 0) {
+          positions.push_back(internalToExposedId(i) - 1);
+        }
+      }
+      leafIds = RankSelectBitvector::fromPositions(positions, internalToExposedId(numLeafIds) - 1);
     }
+    fp.write(reinterpret_cast<const char*>(&DICTIONARY_MAGIC), sizeof(DICTIONARY_MAGIC));
+    fp.write(reinterpret_cast<const char*>(&DICTIONARY_VERSION), sizeof(DICTIONARY_VERSION));
     fp.write(reinterpret_cast<char*>(&(m_stats.numLeaves)), sizeof(m_stats.numLeaves));
     fp.write(reinterpret_cast<char*>(&(m_stats.numInternalNodes)), sizeof(m_stats.numInternalNodes));
     fp.write(reinterpret_cast<char*>(&(m_stats.numEdges)), sizeof(m_stats.numEdges));
     fp.write(reinterpret_cast<char*>(&(m_stats.numLabelBytes)), sizeof(m_stats.numLabelBytes));
-    std::size_t numLeafHoles{m_finalLeafHoles.size()};
+    // leaf holes are only read from older files.
+    std::size_t numLeafHoles{0};
     fp.write(reinterpret_cast<char*>(&numLeafHoles), sizeof(numLeafHoles));
+    std::size_t flags{DictionaryFlags::OutEdgeFirstBytes};
+    if (orderPreservingIds) {
+      flags |= DictionaryFlags::OrderPreservingIds;
+    }
+    if (!leafIds.empty()) {
+      flags |= DictionaryFlags::LeafIdBitvector;
+    }
+    fp.write(reinterpret_cast<char*>(&flags), sizeof(flags));
 
     auto internalNodeHoles{std::vector<csd::Hole>()};
 
@@ -175,7 +133,6 @@ namespace csd {
           continue;
         }
         fp.write(reinterpret_cast<const char* const>(get_label(i, edge)), edge->labelLength);
-        edge->labelOffset = num_labelbytes_written;
         num_labelbytes_written += edge->labelLength;
       }
       if (num_labelbytes_written != m_stats.numLabelBytes) {
@@ -193,13 +150,15 @@ namespace csd {
         auto* edge{get_edge(i)};
         edge->inNodeId = get_new_id(edge->inNodeId, internalNodeHoles);
         if (edge->outNodeIsLeaf) {
-          edge->outNodeId = get_new_id(edge->outNodeId, mmapLeafHoles);
+          edge->outNodeId = orderPreservingIds ? lexicographicRanks.at(edge->outNodeId) : get_new_id(edge->outNodeId, mmapLeafHoles);
         } else {
           edge->outNodeId = get_new_id(edge->outNodeId, internalNodeHoles);
         }
-        edge->labelOffset = labelOffset;
+        // mapped labels are still read through the old offset, when merging out-edges below.
+        auto written{*edge};
+        written.labelOffset = labelOffset;
         labelOffset += edge->labelLength;
-        fp.write(reinterpret_cast<const char* const>(edge), sizeof(*edge));
+        fp.write(reinterpret_cast<const char* const>(&written), sizeof(written));
 
         edge->inNodeId = num_written_edges; // abuse this field to easily access the new Id later
         num_written_edges++;
@@ -212,12 +171,21 @@ namespace csd {
     {
       std::size_t num_written_leafs{0};
       // Write leaf nodes
-      for (std::size_t i{0}; i < m_mmapPointers.leaves.length + m_buffers.leaves.length; i++) { // NOLINT(altera-unroll-loops)
-        auto* n{get_leafNode(i, true)};
-        if (n->occurences > 0) {
-          n->inEdge = get_edge(n->inEdge)->inNodeId; // hack, abused field
-          fp.write(reinterpret_cast<const char* const>(n), sizeof(*n));
-          num_written_leafs++;
+      const auto write_leaf{[this, &fp, &num_written_leafs](LeafNode* const n) {
+        n->inEdge = get_edge(n->inEdge)->inNodeId; // hack, abused field
+        fp.write(reinterpret_cast<const char* const>(n), sizeof(*n));
+        num_written_leafs++;
+      }};
+      if (orderPreservingIds) {
+        for (const auto leafId: lexicographicLeaves) {
+          write_leaf(get_leafNode(leafId));
+        }
+      } else {
+        for (std::size_t i{0}; i < m_mmapPointers.leaves.length + m_buffers.leaves.length; i++) { // NOLINT(altera-unroll-loops)
+          auto* n{get_leafNode(i, true)};
+          if (n->occurences > 0) {
+            write_leaf(n);
+          }
         }
       }
       if (num_written_leafs != m_stats.numLeaves) {
@@ -225,22 +193,12 @@ namespace csd {
       }
     }
 
-    {
-      // Write leaf node holes
-      // bool merge_border = false;
-      std::size_t num_written_holes{0};
-      for (auto& hole: m_finalLeafHoles) {
-        auto* h{&hole};
-        fp.write(reinterpret_cast<const char* const>(&(h->start)), sizeof(h->start));
-        fp.write(reinterpret_cast<const char* const>(&(h->size)), sizeof(h->size));
-        fp.write(reinterpret_cast<const char* const>(&(h->cumulative)), sizeof(h->cumulative));
-        num_written_holes++;
-      }
-      if (num_written_holes != numLeafHoles) {
-        throw std::runtime_error("Wrote unexpected number of leaf node holes");
-      }
+    if (!leafIds.empty()) {
+      leafIds.save(fp);
     }
 
+    std::vector<unsigned char> outEdgeFirstBytes;
+    outEdgeFirstBytes.reserve(m_stats.numEdges);
     {
       // write out-edges
       // std::size_t num_written
@@ -254,6 +212,7 @@ namespace csd {
         while (it.has_next()) {
           auto shifted{get_edge(it.read())->inNodeId}; // hack, abused field
           fp.write(reinterpret_cast<const char* const>(&shifted), sizeof(shifted));
+          outEdgeFirstBytes.push_back(get_label(it.read())[0]);
           num_written_edges++;
           it.proceed();
         }
@@ -287,5 +246,7 @@ namespace csd {
         throw std::runtime_error("Wrote unexpected number of internal nodes");
       }
     }
+
+    fp.write(reinterpret_cast<const char* const>(outEdgeFirstBytes.data()), static_cast<std::streamsize>(outEdgeFirstBytes.size()));
   }
 }
@@ -44,6 +44,12 @@ namespace csd {
     holes.push_back(newHole);
   }
 
+  /**
+   * A bitvector with the exposed IDs (less one) of `numLeaves` leaves set,
+   * given the holes which older files list instead of a bitvector.
+   */
+  auto leafIdBitvector(const std::vector<csd::Hole>& holes, const std::size_t& numLeaves) -> RankSelectBitvector;
+
   template <class T>
   extern void possibly_realloc(TrieBuffer<T>* tb) {
     // this assumes we always add in batches of 1
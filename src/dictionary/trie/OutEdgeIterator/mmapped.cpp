@@ -25,8 +25,14 @@ namespace csd {
     } else {
       m_tooFar = mmapPointers->outEdgeIds.ptr + m_data->get_internalNode(nodeId + 1, 1)->outEdgesOffset;
     }
-    m_next = *m_ptr;
-    m_has_next = true;
+    // the first out-edge might have been deleted since loading.
+    while (m_ptr < m_tooFar && !m_data->edge_exists(*m_ptr)) {
+      ++m_ptr;
+    }
+    m_has_next = m_ptr < m_tooFar;
+    if (m_has_next) {
+      m_next = *m_ptr;
+    }
   }
 
   auto OutEdgeIterator_mmapped::inner_proceed() -> void {
@@ -7,6 +7,9 @@
 
 namespace csd {
 
+  /**
+   * The characters along a path, from the root down. The path must outlive the iterator.
+   */
   class PathCharIterator {
   public:
     PathCharIterator(const DataManager* const data, const TriePath& triePath);
@@ -14,7 +17,7 @@ namespace csd {
     [[nodiscard]] auto has_next() const -> bool;
 
   private:
-    const TriePath m_triePath;
+    const TriePath& m_triePath;
     const DataManager* const m_data;
     std::size_t m_index;
     std::pair<std::size_t, const Edge*> m_segment;
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include "RankSelectBitvector.hpp"
+
+namespace csd {
+  constexpr std::size_t WORD_BITS{64};
+  constexpr std::size_t WORDS_PER_BLOCK{8};
+  constexpr std::size_t BLOCK_BITS{WORD_BITS * WORDS_PER_BLOCK};
+  constexpr std::size_t ONES_PER_SELECT_SAMPLE{512};
+
+  auto RankSelectBitvector::numWords() const -> std::size_t {
+    return (m_numBits + WORD_BITS - 1) / WORD_BITS;
+  }
+  auto RankSelectBitvector::numBlocks() const -> std::size_t {
+    return (numWords() + WORDS_PER_BLOCK - 1) / WORDS_PER_BLOCK;
+  }
+  auto RankSelectBitvector::numSelectSamples() const -> std::size_t {
+    return (m_numOnes + ONES_PER_SELECT_SAMPLE - 1) / ONES_PER_SELECT_SAMPLE;
+  }
+  auto RankSelectBitvector::words() const -> const std::uint64_t* {
+    return m_data;
+  }
+  auto RankSelectBitvector::ranks() const -> const std::uint64_t* {
+    return m_data + numWords();
+  }
+  auto RankSelectBitvector::selects() const -> const std::uint64_t* {
+    // there is one more rank sample than blocks, holding the total.
+    return ranks() + numBlocks() + 1;
+  }
+
+  auto RankSelectBitvector::fromPositions(const std::vector<std::size_t>& positions, const std::size_t& numBits) -> RankSelectBitvector {
+    RankSelectBitvector result;
+    result.m_numBits = numBits;
+    result.m_numOnes = positions.size();
+    auto& storage{result.m_storage};
+    storage.resize(result.numWords() + result.numBlocks() + 1 + result.numSelectSamples(), 0);
+    for (const auto& position: positions) {
+      if (position >= numBits) {
+        throw std::runtime_error("Bit position out of range");
+      }
+      storage[position / WORD_BITS] |= std::uint64_t{1} << (position % WORD_BITS);
+    }
+    auto* const ranks{storage.data() + result.numWords()};
+    auto* const selects{ranks + result.numBlocks() + 1};
+    std::size_t ones{0};
+    for (std::size_t block{0}; block < result.numBlocks(); block++) {
+      ranks[block] = ones;
+      for (std::size_t word{block * WORDS_PER_BLOCK}; word < std::min((block + 1) * WORDS_PER_BLOCK, result.numWords()); word++) {
+        ones += std::popcount(storage[word]);
+      }
+    }
+    ranks[result.numBlocks()] = ones;
+    for (std::size_t sample{0}; sample < result.numSelectSamples(); sample++) {
+      selects[sample] = positions[sample * ONES_PER_SELECT_SAMPLE] / BLOCK_BITS;
+    }
+    result.m_data = storage.data();
+    return result;
+  }
+
+  auto RankSelectBitvector::load(const unsigned char* ptr) -> const unsigned char* {
+    m_numBits = *reinterpret_cast<const std::size_t*>(ptr);
+    ptr += sizeof(std::size_t);
+    m_numOnes = *reinterpret_cast<const std::size_t*>(ptr);
+    ptr += sizeof(std::size_t);
+    m_storage.clear();
+    m_data = reinterpret_cast<const std::uint64_t*>(ptr);
+    return ptr + sizeof(std::uint64_t) * (numWords() + numBlocks() + 1 + numSelectSamples());
+  }
+
+  auto RankSelectBitvector::save(std::ostream& fp) const -> void {
+    fp.write(reinterpret_cast<const char*>(&m_numBits), sizeof(m_numBits));
+    fp.write(reinterpret_cast<const char*>(&m_numOnes), sizeof(m_numOnes));
+    fp.write(reinterpret_cast<const char*>(m_data), sizeof(std::uint64_t) * (numWords() + numBlocks() + 1 + numSelectSamples()));
+  }
+
+  auto RankSelectBitvector::rank(const std::size_t& position) const -> std::size_t {
+    const auto block{position / BLOCK_BITS};
+    std::size_t result{ranks()[block]};
+    const auto word{position / WORD_BITS};
+    for (std::size_t i{block * WORDS_PER_BLOCK}; i < word; i++) {
+      result += std::popcount(words()[i]);
+    }
+    const auto offset{position % WORD_BITS};
+    if (offset != 0) {
+      result += std::popcount(words()[word] & ((std::uint64_t{1} << offset) - 1));
+    }
+    return result;
+  }
+
+  auto RankSelectBitvector::select(const std::size_t& rank) const -> std::size_t {
+    if (rank >= m_numOnes) {
+      throw std::runtime_error("Select past the last set bit");
+    }
+    auto block{static_cast<std::size_t>(selects()[rank / ONES_PER_SELECT_SAMPLE])};
+    while (ranks()[block + 1] <= rank) {
+      block++;
+    }
+    auto remaining{rank - ranks()[block]};
+    for (auto i{block * WORDS_PER_BLOCK};; i++) {
+      auto word{words()[i]};
+      const auto ones{static_cast<std::size_t>(std::popcount(word))};
+      if (remaining < ones) {
+        for (; remaining > 0; remaining--) {
+          word &= word - 1;
+        }
+        return i * WORD_BITS + std::countr_zero(word);
+      }
+      remaining -= ones;
+    }
+  }
+}
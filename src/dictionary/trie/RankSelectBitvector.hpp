@@ -0,0 +1,76 @@
+#ifndef CSD_RANK_SELECT_BITVECTOR_HPP
+#define CSD_RANK_SELECT_BITVECTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace csd {
+
+  /**
+   * A bitvector which counts the set bits before a position (rank)
+   * and finds the position of the k-th set bit (select).
+   *
+   * Ranks are sampled every 512 bits, one cache line of words, and positions of set bits every 512 set bits.
+   * Rank takes constant time, and so does select as long as set bits are about as dense everywhere,
+   * as they are when most bits are set.
+   * The serialized form is the same as the in-memory one, so that it can be used straight from a mapped file.
+   */
+  class RankSelectBitvector {
+  public:
+    RankSelectBitvector() = default;
+    RankSelectBitvector(const RankSelectBitvector&) = delete;
+    RankSelectBitvector(RankSelectBitvector&&) = default;
+    auto operator=(const RankSelectBitvector&) -> RankSelectBitvector& = delete;
+    auto operator=(RankSelectBitvector&&) -> RankSelectBitvector& = default;
+
+    /**
+     * Builds a bitvector of `numBits` bits, with the given positions set, which must be ascending.
+     */
+    static auto fromPositions(const std::vector<std::size_t>& positions, const std::size_t& numBits) -> RankSelectBitvector;
+
+    /**
+     * Uses a serialized bitvector in place. Returns the pointer past it.
+     */
+    auto load(const unsigned char* ptr) -> const unsigned char*;
+    auto save(std::ostream& fp) const -> void;
+
+    /**
+     * The number of set bits in [0, position).
+     */
+    [[nodiscard]] auto rank(const std::size_t& position) const -> std::size_t;
+    /**
+     * The position of the set bit with the given rank, counting from 0.
+     */
+    [[nodiscard]] auto select(const std::size_t& rank) const -> std::size_t;
+
+    [[nodiscard]] auto size() const -> std::size_t {
+      return m_numBits;
+    }
+    [[nodiscard]] auto numOnes() const -> std::size_t {
+      return m_numOnes;
+    }
+    [[nodiscard]] auto empty() const -> bool {
+      return m_numBits == 0;
+    }
+
+  private:
+    std::size_t m_numBits{0};
+    std::size_t m_numOnes{0};
+    /**
+     * The words, followed by the rank samples and the select samples.
+     */
+    const std::uint64_t* m_data{nullptr};
+    std::vector<std::uint64_t> m_storage;
+
+    [[nodiscard]] auto numWords() const -> std::size_t;
+    [[nodiscard]] auto numBlocks() const -> std::size_t;
+    [[nodiscard]] auto numSelectSamples() const -> std::size_t;
+    [[nodiscard]] auto words() const -> const std::uint64_t*;
+    [[nodiscard]] auto ranks() const -> const std::uint64_t*;
+    [[nodiscard]] auto selects() const -> const std::uint64_t*;
+  };
+}
+
+#endif
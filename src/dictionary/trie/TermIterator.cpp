@@ -10,6 +10,23 @@
 
 namespace csd {
 
+  /**
+   * Appends the labels on the path from the root down to an internal node.
+  */
+  inline auto append_node_prefix(const DataManager* const data, const std::size_t& nodeId, std::string& buffer) -> void {
+    TriePath path;
+    for (auto node{nodeId}; node != 0;) {
+      const auto edgeId{data->get_internalNode(node)->inEdge};
+      const auto* const edge{data->get_edge(edgeId)};
+      path.push_back({edgeId, edge});
+      node = edge->inNodeId;
+    }
+    for (auto i{path.size()}; i > 0; i--) {
+      const auto& [edgeId, edge]{path.at(i - 1)};
+      buffer.append(reinterpret_cast<const char*>(data->get_label(edgeId, edge)), edge->labelLength);
+    }
+  }
+
   TermIterator::TermIterator(const DataManager* const data, const std::string& prefix)
     : m_iterators{std::vector<csd::OutEdgeIterator>()}, m_data{data} {
     const auto scope_info{TrieAlgorithm::get_scope(data, prefix)};
@@ -27,26 +44,40 @@ namespace csd {
     if (is_singleton) {
       m_has_next = true;
       m_next = m_scope;
+      TrieAlgorithm::append_string(data, m_scope, m_term);
     } else {
+      append_node_prefix(data, m_scope, m_term);
       m_iterators.emplace_back(OutEdgeIterator{m_scope, data});
+      m_termLengths.push_back(m_term.size());
       inner_proceed();
     }
   }
 
+  auto TermIterator::term() const -> const std::string& {
+    if (!has_next()) {
+      throw std::runtime_error("There is no next.");
+    }
+    return m_term;
+  }
+
   auto TermIterator::inner_proceed() -> void {
     while (!m_iterators.empty()) {
       while (m_iterators.at(m_iterators.size() - 1).has_next()) {
         const auto edgeId{m_iterators.at(m_iterators.size() - 1).read()};
         const auto* const edge{m_data->get_edge(edgeId)};
         m_iterators.at(m_iterators.size() - 1).proceed();
+        m_term.resize(m_termLengths.back());
+        m_term.append(reinterpret_cast<const char*>(m_data->get_label(edgeId, edge)), term_bytes(edge));
         if (edge->outNodeIsLeaf) {
           m_next = edge->outNodeId;
           m_has_next = true;
           return;
         }
         m_iterators.emplace_back(OutEdgeIterator(edge->outNodeId, m_data));
+        m_termLengths.push_back(m_term.size());
       }
       m_iterators.pop_back();
+      m_termLengths.pop_back();
     }
     m_has_next = false;
   }
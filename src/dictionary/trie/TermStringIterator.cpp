@@ -15,16 +15,22 @@ namespace csd {
     if (m_has_next) {
       const auto next_id{m_termiterator.read()};
       const auto* const leaf{m_data->get_leafNode(next_id)};
-      m_next = std::pair<std::string, std::size_t>{TrieAlgorithm::id_to_string(m_data, next_id), leaf->occurences};
+      m_next = std::pair<std::string, std::size_t>{m_termiterator.term(), leaf->occurences};
     }
   }
+  auto TermStringIterator::id() const -> std::size_t {
+    if (!has_next()) {
+      throw std::runtime_error("There is no next.");
+    }
+    return m_data->internalToExposedId(m_termiterator.read());
+  }
   auto TermStringIterator::inner_proceed() -> void {
     m_termiterator.proceed();
     m_has_next = m_termiterator.has_next();
     if (m_has_next) {
       const auto next_id{m_termiterator.read()};
       const auto* const leaf{m_data->get_leafNode(next_id)};
-      m_next = std::pair<std::string, std::size_t>{TrieAlgorithm::id_to_string(m_data, next_id), leaf->occurences};
+      m_next = std::pair<std::string, std::size_t>{m_termiterator.term(), leaf->occurences};
     }
   }
 }
@@ -29,6 +29,21 @@ namespace csd {
     return r;
   }
 
+  auto Trie::merge(const Trie& other) -> std::vector<std::size_t> {
+    if (&other == this) {
+      throw std::runtime_error("Tried to merge a trie into itself");
+    }
+    std::vector<std::size_t> ids;
+    for (const auto& [otherLeafId, leafId]: TrieAlgorithm::merge(m_data, other.m_data)) {
+      const auto otherId{other.m_data->internalToExposedId(otherLeafId)};
+      if (ids.size() <= otherId) {
+        ids.resize(otherId + 1, 0);
+      }
+      ids.at(otherId) = m_data->internalToExposedId(leafId);
+    }
+    return ids;
+  }
+
   void Trie::addOccurrences(const std::size_t& id, const std::size_t& occurences) {
     m_data->get_leafNode(m_data->exposedToInternalId(id))->occurences += occurences;
   }
@@ -60,6 +75,24 @@ namespace csd {
     return TrieAlgorithm::id_to_string(m_data, internal_id);
   }
 
+  auto Trie::append_string(const std::size_t& id, std::string& buffer) const -> void {
+    if (id == 0) {
+      throw std::runtime_error("Invalid Id (append_string)");
+    }
+    TrieAlgorithm::append_string(m_data, m_data->exposedToInternalId(id), buffer);
+  }
+
+  auto Trie::decode(std::span<const std::size_t> ids, std::string& buffer, std::vector<std::string_view>& terms) const -> void {
+    std::vector<std::size_t> internalIds(ids.size());
+    for (std::size_t i{0}; i < ids.size(); i++) {
+      if (ids[i] == 0) {
+        throw std::runtime_error("Invalid Id (decode)");
+      }
+      internalIds[i] = m_data->exposedToInternalId(ids[i]);
+    }
+    TrieAlgorithm::decode(m_data, internalIds, buffer, terms);
+  }
+
   auto Trie::get_path(const std::size_t& exposedId) const -> TriePath {
     if (exposedId == 0) {
       throw std::runtime_error("Invalid Id (get_path)");
@@ -81,8 +114,8 @@ namespace csd {
       auto i2 = path2.size() - 1;
       while (true) {
         if (path1.at(i1).first != path2.at(i2).first) {
-          const auto* const label1{m_data->get_label(path1.at(i1).first, static_cast<Edge*>(path1.at(i1).second))};
-          const auto* const label2{m_data->get_label(path2.at(i2).first, static_cast<Edge*>(path2.at(i2).second))};
+          const auto* const label1{m_data->get_label(path1.at(i1).first, path1.at(i1).second)};
+          const auto* const label2{m_data->get_label(path2.at(i2).first, path2.at(i2).second)};
           return label1[0] - label2[0];
         }
         i1--;
@@ -119,6 +152,9 @@ namespace csd {
     if (exposedId1 == exposedId2) {
       return 0;
     }
+    if (hasOrderPreservingIds()) {
+      return exposedId1 < exposedId2 ? -1 : 1;
+    }
     const auto path1{get_path(exposedId1)};
     const auto path2{get_path(exposedId2)};
     auto i1 = path1.size() - 1;
@@ -126,8 +162,8 @@ namespace csd {
     int result;
     while (true) {
       if (path1.at(i1).first != path2.at(i2).first) {
-        const auto* const label1{m_data->get_label(path1.at(i1).first, static_cast<Edge*>(path1.at(i1).second))};
-        const auto* const label2{m_data->get_label(path2.at(i2).first, static_cast<Edge*>(path2.at(i2).second))};
+        const auto* const label1{m_data->get_label(path1.at(i1).first, path1.at(i1).second)};
+        const auto* const label2{m_data->get_label(path2.at(i2).first, path2.at(i2).second)};
         result = label1[0] - label2[0];
         break;
       }
@@ -153,8 +189,28 @@ namespace csd {
    * @brief Write to a file.
    *
    */
-  void Trie::save(std::ostream& fp) {
-    m_data->save(fp);
+  void Trie::save(std::ostream& fp, bool orderPreservingIds) {
+    m_data->save(fp, orderPreservingIds);
+  }
+
+  auto Trie::hasOrderPreservingIds() const -> bool {
+    return m_data->hasOrderPreservingIds();
+  }
+
+  auto Trie::maxId() const -> std::size_t {
+    return m_data->maxExposedId();
+  }
+
+  auto Trie::lexicographicIds() const -> std::vector<std::size_t> {
+    return m_data->lexicographicIds();
+  }
+
+  auto Trie::occurrenceHistogram() const -> std::vector<std::size_t> {
+    return m_data->occurrenceHistogram();
+  }
+
+  auto Trie::memoryUsage() const -> std::size_t {
+    return m_data->memoryUsage();
   }
 
   auto Trie::load(unsigned char* ptr) -> void {
@@ -2,6 +2,10 @@
 #define CSD_TRIE_ALGORITHM_HPP
 
 #include <cstddef>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "../DataManager/DataManager.hpp"
 
@@ -13,11 +17,28 @@ namespace csd {
     }
   };
 
+  /**
+   * The number of bytes a label contributes to a term. Labels into leaves end with a null byte, which doesn't.
+   */
+  inline auto term_bytes(const Edge* const edge) -> std::size_t {
+    return edge->labelLength - (edge->outNodeIsLeaf ? 1 : 0);
+  }
+
   class TrieAlgorithm {
   public:
     // read-only operations
 
     static auto id_to_string(const DataManager* const data, const std::size_t& id, bool dontThrowOnNotFound = false) -> std::string;
+    /**
+     * Appends the term of a leaf to `buffer`, without allocating anything else.
+    */
+    static auto append_string(const DataManager* const data, const std::size_t& id, std::string& buffer, bool dontThrowOnNotFound = false) -> void;
+    /**
+     * Appends the terms of many leaves to `buffer`, and sets `terms` to views of them, in the order of `ids`.
+     * Leaves are decoded in order of their IDs, and each walk up stops at an ancestor of the previous leaf,
+     * whose part of the term is copied instead.
+    */
+    static auto decode(const DataManager* const data, std::span<const std::size_t> ids, std::string& buffer, std::vector<std::string_view>& terms) -> void;
     static auto extract_path(const DataManager* const data, const std::size_t& id, bool dontThrowOnNotFound = false) -> TriePath;
     static auto string_to_id(const DataManager* const data, const std::string& rdfTerm) -> std::pair<std::size_t, std::size_t>;
     /**
@@ -26,12 +47,21 @@ namespace csd {
      * The third item, a std::boolean, represents whether the outnode is a leaf 
     */
     static auto get_scope(const DataManager* const data, const std::string& prefix) -> std::tuple<std::size_t, bool, bool>;
-    static auto compile_path_label(const DataManager* const data, const TriePath& path, bool dontThrowOnNotFound) -> std::string;
 
     // update operations
 
     static auto insert(DataManager* data, const std::string& rdfTerm, const std::size_t& occurences) -> std::pair<std::size_t, bool>;
     static auto remove(DataManager* data, const std::size_t& id, const std::size_t& occurences = 1) -> bool;
+    /**
+     * Splits the label of an edge after `at` bytes, by inserting a new internal node, whose ID is returned.
+    */
+    static auto split_edge(DataManager* data, const std::size_t& edgeId, const std::size_t& at) -> std::size_t;
+    /**
+     * Adds all terms of `other` to `data`, walking both tries side by side.
+     * Subtrees which only exist in `other` are copied as a whole.
+     * Returns pairs of internal leaf IDs: (leaf in `other`, leaf in `data`).
+    */
+    static auto merge(DataManager* data, const DataManager* const other) -> std::vector<std::pair<std::size_t, std::size_t>>;
   };
 }
 
@@ -1,50 +1,115 @@
+#include <algorithm>
 #include <cstring>
-#include <vector>
+#include <numeric>
 
 #include "./TrieAlgorithm.hpp"
 
 namespace csd {
-  auto TrieAlgorithm::compile_path_label(const DataManager* const data, const TriePath& triePath, bool dontThrowOnNotFound) -> std::string {
-    // todo evaluate whether it pays off to pre-compute the string length.
-
-    std::size_t lengths_sum{0};
-    for (auto edge: triePath) {
-      lengths_sum += edge.second->labelLength;
+  auto TrieAlgorithm::append_string(const DataManager* const data, const std::size_t& id, std::string& buffer, bool dontThrowOnNotFound) -> void {
+    // walk up twice: once for the length, then to fill in the labels from the back.
+    const auto* const leaf{data->get_leafNode(id, dontThrowOnNotFound)};
+    std::size_t length{0};
+    const auto* edge{data->get_edge(leaf->inEdge, dontThrowOnNotFound)};
+    while (true) {
+      length += term_bytes(edge);
+      if (edge->inNodeId == 0) {
+        break;
+      }
+      edge = data->get_edge(data->get_internalNode(edge->inNodeId, dontThrowOnNotFound)->inEdge, dontThrowOnNotFound);
     }
-    std::string result;
-    result.reserve(lengths_sum-1);
-    for (int index = triePath.size() - 1; index >= 0; index--) {
-      const auto edge{triePath.at(index)};
-      const auto* const edgeLabel{data->get_label(edge.first, edge.second, dontThrowOnNotFound)};
-      result += std::string{reinterpret_cast<const char* const>(edgeLabel), edge.second->labelLength - (edge.second->outNodeIsLeaf?1:0)};
+    auto end{buffer.size() + length};
+    buffer.resize(end);
+    auto edgeId{leaf->inEdge};
+    while (true) {
+      edge = data->get_edge(edgeId, dontThrowOnNotFound);
+      end -= term_bytes(edge);
+      std::memcpy(buffer.data() + end, data->get_label(edgeId, edge, dontThrowOnNotFound), term_bytes(edge));
+      if (edge->inNodeId == 0) {
+        break;
+      }
+      edgeId = data->get_internalNode(edge->inNodeId, dontThrowOnNotFound)->inEdge;
     }
-    return result;
   }
 
   auto TrieAlgorithm::id_to_string(const DataManager* const data, const std::size_t& id, bool dontThrowOnNotFound) -> std::string {
-    return compile_path_label(data, extract_path(data, id), dontThrowOnNotFound);
+    std::string result;
+    append_string(data, id, result, dontThrowOnNotFound);
+    return result;
   }
 
-  std::size_t maxDepth{5};
+  auto TrieAlgorithm::decode(const DataManager* const data, std::span<const std::size_t> ids, std::string& buffer, std::vector<std::string_view>& terms) -> void {
+    std::vector<std::size_t> order(ids.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&ids](const std::size_t& lhs, const std::size_t& rhs) {
+      return ids[lhs] < ids[rhs];
+    });
+    // offset and length of each term in the buffer, since it may still move.
+    std::vector<std::pair<std::size_t, std::size_t>> ranges(ids.size());
+    // the internal nodes on the path of the previous term, from the root down, with the length of the term up to them.
+    std::vector<std::pair<std::size_t, std::size_t>> ancestors{{0, 0}};
+    std::size_t previousStart{0};
+    TriePath path;
+    for (std::size_t i{0}; i < order.size(); i++) {
+      const auto index{order[i]};
+      if (i > 0 && ids[order[i - 1]] == ids[index]) {
+        ranges[index] = ranges[order[i - 1]];
+        continue;
+      }
+      // walk up until reaching an ancestor of the previous term.
+      path.clear();
+      auto edgeId{data->get_leafNode(ids[index])->inEdge};
+      std::size_t sharedAncestor;
+      while (true) {
+        const auto* const edge{data->get_edge(edgeId)};
+        path.push_back({edgeId, edge});
+        const auto found{std::find_if(ancestors.begin(), ancestors.end(), [edge](const auto& ancestor) {
+          return ancestor.first == edge->inNodeId;
+        })};
+        if (found != ancestors.end()) {
+          sharedAncestor = found - ancestors.begin();
+          break;
+        }
+        edgeId = data->get_internalNode(edge->inNodeId)->inEdge;
+      }
+      ancestors.resize(sharedAncestor + 1);
+
+      const auto sharedLength{ancestors.back().second};
+      std::size_t length{sharedLength};
+      for (std::size_t j{0}; j < path.size(); j++) {
+        length += term_bytes(path.at(j).second);
+      }
+      const auto start{buffer.size()};
+      buffer.reserve(start + length);
+      buffer.append(buffer.data() + previousStart, sharedLength);
+      for (auto j{path.size()}; j-- > 0;) {
+        const auto& [id, edge]{path.at(j)};
+        buffer.append(reinterpret_cast<const char*>(data->get_label(id, edge)), term_bytes(edge));
+        if (!edge->outNodeIsLeaf) {
+          ancestors.emplace_back(edge->outNodeId, buffer.size() - start);
+        }
+      }
+      ranges[index] = {start, length};
+      previousStart = start;
+    }
+    terms.resize(ids.size());
+    for (std::size_t i{0}; i < ids.size(); i++) {
+      terms[i] = std::string_view{buffer.data() + ranges[i].first, ranges[i].second};
+    }
+  }
 
   auto TrieAlgorithm::extract_path(const DataManager* const data, const std::size_t& leafNodeId, bool dontThrowOnNotFound) -> TriePath {
-    auto triePath{TriePath()};
-    // give an initial guesstimate for the capacity, to avoid needless reallocations
-    triePath.reserve(maxDepth);
+    TriePath triePath;
     const auto* const leaf{data->get_leafNode(leafNodeId, dontThrowOnNotFound)};
     auto* edge{data->get_edge(leaf->inEdge, dontThrowOnNotFound)};
     {
       const auto inEdgeId{leaf->inEdge};
-      triePath.emplace_back(std::pair{inEdgeId, edge});
+      triePath.push_back({inEdgeId, edge});
     }
     while (edge->inNodeId > 0) { // NOLINT(altera-unroll-loops)
       const auto* const internalNode{data->get_internalNode(edge->inNodeId, dontThrowOnNotFound)};
       edge = data->get_edge(internalNode->inEdge, dontThrowOnNotFound);
       const auto inEdgeId{internalNode->inEdge};
-      triePath.emplace_back(std::pair{inEdgeId, edge});
-    }
-    if (triePath.size() > maxDepth) {
-      maxDepth = triePath.size();
+      triePath.push_back({inEdgeId, edge});
     }
     return triePath;
   }
@@ -3,7 +3,6 @@
 
 #include "../DataManager/DataManager.hpp"
 #include "../LabelComparator.hpp"
-#include "../TrieNavigator.hpp"
 #include "./TrieAlgorithm.hpp"
 
 namespace csd {
@@ -31,6 +30,36 @@ namespace csd {
     return newLeafNodeId;
   }
 
+  auto TrieAlgorithm::split_edge(DataManager* data, const std::size_t& edgeId, const std::size_t& at) -> std::size_t {
+    // a --e1--> b   =>   a --e1--> x --e2--> b
+    const auto xId{data->add_internalNode(edgeId)};
+
+    const auto* e1{data->get_edge(edgeId)};
+    const auto e2Id{data->add_edge(
+      data->get_label(edgeId, e1),
+      at,
+      e1->labelLength,
+      e1->outNodeIsLeaf,
+      xId,
+      e1->outNodeId)};
+
+    // need to re-get it, since we might have reallocated
+    auto* const edge{data->get_edge(edgeId)};
+
+    data->add_outEdge(xId, e2Id);
+
+    if (edge->outNodeIsLeaf) {
+      data->get_leafNode(edge->outNodeId, true)->inEdge = e2Id;
+    } else {
+      data->get_internalNode(edge->outNodeId, true)->inEdge = e2Id;
+    }
+
+    data->shrink_label(edgeId, at);
+    edge->outNodeId = xId;
+    edge->outNodeIsLeaf = false;
+    return xId;
+  }
+
   auto TrieAlgorithm::insert(DataManager* data, const std::string& term, const std::size_t& occurrences) -> std::pair<std::size_t, bool> {
     // check for special case: first string
     if (data->getStats()->numLeaves == 0) {
@@ -38,30 +67,27 @@ namespace csd {
       return result;
     }
 
-    TrieNavigator navigator{data};
-
     const auto* key{reinterpret_cast<const unsigned char* const>(term.c_str())};
     const auto keyLength{term.size()};
 
     LabelComparator comparator{term};
+    std::size_t nodeId{0};
     std::size_t keyOffset{0};
 
     while (true) {
-      const auto comparisonResult{comparator.compare(navigator.label(), navigator.edge()->labelLength, keyOffset)};
-      if (comparisonResult == TermsShareNoPrefix) {
-        // no prefix match here, but maybe on a following edge.
-        if (comparator.labelIsLexicographicallyAfterKey() || !navigator.mayGoRight()) {
-          const std::pair<std::size_t, bool> result{insertLeafNode(data, key, keyOffset, keyLength, navigator.edge()->inNodeId, occurrences), true};
-          return result;
-        }
-        navigator.goRight();
-        continue;
+      const auto edgeId{data->findOutEdge(nodeId, key[keyOffset])};
+      if (!edgeId) {
+        // no out-edge shares a prefix with the rest of the key.
+        const std::pair<std::size_t, bool> result{insertLeafNode(data, key, keyOffset, keyLength, nodeId, occurrences), true};
+        return result;
       }
+      const auto* const edge{data->get_edge(*edgeId)};
+      const auto comparisonResult{comparator.compare(data->get_label(*edgeId, edge), edge->labelLength, keyOffset)};
 
       if (comparisonResult == TermsAreEqual) {
         // Match, already inserted. Increment occurences and return the outnode
-        navigator.leaf()->occurences += occurrences;
-        const auto resultId{navigator.edge()->outNodeId};
+        data->get_leafNode(edge->outNodeId)->occurences += occurrences;
+        const auto resultId{edge->outNodeId};
         const std::pair<std::size_t, bool> result{resultId, false};
         return result;
       }
@@ -69,8 +95,8 @@ namespace csd {
       if (comparisonResult == FirstTermIsPrefixOfSecondTerm) {
         // e->outNodeId is an internal node, and e->label is a prefix of `rdfTerm`.
         // Insert the remaining chars as a new child under this->outNode.
-        keyOffset += navigator.edge()->labelLength;
-        navigator.goDown();
+        keyOffset += edge->labelLength;
+        nodeId = edge->outNodeId;
         continue;
       }
       if (comparisonResult == SecondTermIsPrefixOfFirstTerm) {
@@ -81,6 +107,10 @@ namespace csd {
         throw std::runtime_error("Should not reach this");
       }
 
+      if (comparisonResult == TermsShareNoPrefix) {
+        throw std::runtime_error("Found an out-edge which doesn't start like the key");
+      }
+
       // COMMON_PREFIX : a strict prefix of e->label is a strict prefix of rdfTerm.
       // We must break up this edge, as such:
       //
@@ -90,30 +120,7 @@ namespace csd {
       //               x --e3-> c
       //
 
-      const auto xId{data->add_internalNode(navigator.edgeId())};
-
-      const auto e2Id{data->add_edge(
-        navigator.label(),
-        comparator.mismatchIndex(),
-        navigator.edge()->labelLength,
-        navigator.edge()->outNodeIsLeaf,
-        xId,
-        navigator.edge()->outNodeId)};
-
-      // need to re-get it, since we might have reallocated
-      navigator.refreshEdge();
-
-      data->add_outEdge(xId, e2Id);
-
-      if (navigator.edge()->outNodeIsLeaf) {
-        navigator.leaf()->inEdge = e2Id;
-      } else {
-        navigator.outNode()->inEdge = e2Id;
-      }
-
-      data->shrink_label(navigator.edgeId(), comparator.mismatchIndex());
-      navigator.edge()->outNodeId = xId;
-      navigator.edge()->outNodeIsLeaf = false;
+      const auto xId{TrieAlgorithm::split_edge(data, *edgeId, comparator.mismatchIndex())};
 
       keyOffset += comparator.mismatchIndex();
 
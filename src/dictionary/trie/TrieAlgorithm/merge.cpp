@@ -0,0 +1,109 @@
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <dictionary/trie/OutEdgeIterator.hpp>
+
+#include "./TrieAlgorithm.hpp"
+
+namespace csd {
+
+  namespace {
+    /**
+     * An edge of the other trie, the label of which (from `labelOffset` on)
+     * remains to be merged below `targetNodeId`.
+     */
+    struct PendingEdge {
+      std::size_t targetNodeId;
+      std::size_t sourceEdgeId;
+      std::size_t labelOffset;
+      /**
+       * Whether the target node was created by the merge, so that there is nothing to merge with.
+       */
+      bool copy;
+    };
+  }
+
+  auto TrieAlgorithm::merge(DataManager* data, const DataManager* const other) -> std::vector<std::pair<std::size_t, std::size_t>> {
+    std::vector<std::pair<std::size_t, std::size_t>> leaves;
+    if (other->getStats()->numLeaves == 0) {
+      return leaves;
+    }
+    if (data->getStats()->numInternalNodes == 0) {
+      data->add_internalNode(0);
+    }
+
+    std::vector<PendingEdge> pending;
+    const auto pushOutEdges{[&](const std::size_t& targetNodeId, const std::size_t& sourceNodeId, bool copy) {
+      for (OutEdgeIterator it{sourceNodeId, other}; it.has_next(); it.proceed()) {
+        pending.push_back({targetNodeId, it.read(), 0, copy});
+      }
+    }};
+    pushOutEdges(0, 0, false);
+
+    while (!pending.empty()) {
+      const auto current{pending.back()};
+      pending.pop_back();
+
+      const auto* const sourceEdge{other->get_edge(current.sourceEdgeId)};
+      const auto* const sourceLabel{other->get_label(current.sourceEdgeId, sourceEdge)};
+      const auto sourceLength{sourceEdge->labelLength - current.labelOffset};
+
+      auto targetNodeId{current.targetNodeId};
+      auto labelOffset{current.labelOffset};
+      if (!current.copy) {
+        if (const auto found{data->findOutEdge(targetNodeId, sourceLabel[current.labelOffset])}) {
+          const auto edgeId{*found};
+          const auto* const edge{data->get_edge(edgeId)};
+          const auto* const label{data->get_label(edgeId, edge)};
+          const auto length{edge->labelLength};
+          std::size_t common{0};
+          while (common < length && common < sourceLength && label[common] == sourceLabel[current.labelOffset + common]) {
+            common++;
+          }
+
+          if (common == length && common == sourceLength) {
+            // Equal labels, which both end in a null byte if either does.
+            if (sourceEdge->outNodeIsLeaf) {
+              const auto* const sourceLeaf{other->get_leafNode(sourceEdge->outNodeId)};
+              data->get_leafNode(edge->outNodeId)->occurences += sourceLeaf->occurences;
+              leaves.emplace_back(sourceEdge->outNodeId, edge->outNodeId);
+            } else {
+              pushOutEdges(edge->outNodeId, sourceEdge->outNodeId, false);
+            }
+            continue;
+          }
+          if (common == length) {
+            // The label of this trie is a prefix, so it can't end in a null byte. Continue below it.
+            pending.push_back({edge->outNodeId, current.sourceEdgeId, current.labelOffset + common, false});
+            continue;
+          }
+
+          // The labels diverge (or the other label ends) within this label.
+          const auto xId{split_edge(data, edgeId, common)};
+          if (common == sourceLength) {
+            pushOutEdges(xId, sourceEdge->outNodeId, false);
+            continue;
+          }
+          targetNodeId = xId;
+          labelOffset += common;
+        }
+      }
+
+      // Nothing to merge with: copy the edge, and the subtree below it.
+      const auto edgeId{data->add_edge(sourceLabel, labelOffset, sourceEdge->labelLength, sourceEdge->outNodeIsLeaf, targetNodeId, 0)};
+      if (sourceEdge->outNodeIsLeaf) {
+        const auto leafId{data->add_leafNode(edgeId, other->get_leafNode(sourceEdge->outNodeId)->occurences)};
+        data->get_edge(edgeId)->outNodeId = leafId;
+        leaves.emplace_back(sourceEdge->outNodeId, leafId);
+      } else {
+        const auto nodeId{data->add_internalNode(edgeId)};
+        data->get_edge(edgeId)->outNodeId = nodeId;
+        pushOutEdges(nodeId, sourceEdge->outNodeId, true);
+      }
+      data->add_outEdge(targetNodeId, edgeId);
+    }
+    return leaves;
+  }
+}
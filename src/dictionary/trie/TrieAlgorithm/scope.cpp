@@ -1,7 +1,6 @@
 
 
 #include "../LabelComparator.hpp"
-#include "../TrieNavigator.hpp"
 #include "TrieAlgorithm.hpp"
 
 namespace csd {
@@ -13,38 +12,36 @@ namespace csd {
       return {0, true, false};
     }
 
-    auto navigator = TrieNavigator(data);
+    if (data->getStats()->numLeaves == 0) {
+      return {0, false, false};
+    }
     LabelComparator comparator{prefix};
+    std::size_t nodeId{0};
     std::size_t keyOffset{0};
 
     while (true) {
-      const auto comparisonResult{comparator.compare(navigator.label(), navigator.edge()->labelLength, keyOffset)};
-      if (comparisonResult == TermsShareNoPrefix) {
-        // no prefix match here, but maybe on a following edge.
-        if (comparator.labelIsLexicographicallyAfterKey() || !navigator.mayGoRight()) {
-          // there is no following edge, so no results. 
-          return {0, false, false};
-        }
-        navigator.goRight();
-        continue;
+      const auto edgeId{data->findOutEdge(nodeId, prefix.at(keyOffset))};
+      if (!edgeId) {
+        // no edge continues the prefix, so no results.
+        return {0, false, false};
       }
+      const auto* const edge{data->get_edge(*edgeId)};
+      const auto comparisonResult{comparator.compare(data->get_label(*edgeId, edge), edge->labelLength, keyOffset)};
 
       if (comparisonResult == FirstTermIsPrefixOfSecondTerm) {
         // the path's label is a prefix of the search term
         // continue from this child.
         keyOffset += comparator.mismatchIndex();
         if (keyOffset==prefix.size()){
-          const auto outNodeId{navigator.edge()->outNodeId};
-          return {outNodeId, true, navigator.edge()->outNodeIsLeaf};
+          return {edge->outNodeId, true, edge->outNodeIsLeaf};
         }
-        navigator.goDown();
+        nodeId = edge->outNodeId;
         continue;
       }
 
       if (comparisonResult == TermsAreEqual || comparisonResult == SecondTermIsPrefixOfFirstTerm) {
-        const auto outNodeId{navigator.edge()->outNodeId};
         // there is exactly one result. 
-        return {outNodeId, true, navigator.edge()->outNodeIsLeaf};
+        return {edge->outNodeId, true, edge->outNodeIsLeaf};
       }
 
       // comparisonResult == TermsSharePrefix
@@ -1,34 +1,34 @@
 #include <stdexcept>
 
 #include "../LabelComparator.hpp"
-#include "../TrieNavigator.hpp"
 #include "TrieAlgorithm.hpp"
 
 namespace csd {
 
   auto TrieAlgorithm::string_to_id(const DataManager* const data, const std::string& term) -> std::pair<std::size_t, std::size_t> {
-    auto navigator = TrieNavigator(data);
+    if (data->getStats()->numLeaves == 0) {
+      throw StringNotFoundException();
+    }
     LabelComparator comparator{term};
+    std::size_t nodeId{0};
     std::size_t keyOffset{0};
 
     while (true) {
-      const auto comparisonResult{comparator.compare(navigator.label(), navigator.edge()->labelLength, keyOffset)};
-
-      if (comparisonResult == TermsShareNoPrefix) {
-        if (comparator.labelIsLexicographicallyAfterKey() || !navigator.mayGoRight()) {
-          throw StringNotFoundException();
-        }
-        navigator.goRight();
-        continue;
+      // the terminating null byte is part of the key, so this is in range.
+      const auto edgeId{data->findOutEdge(nodeId, term.c_str()[keyOffset])};
+      if (!edgeId) {
+        throw StringNotFoundException();
       }
+      const auto* const edge{data->get_edge(*edgeId)};
+      const auto comparisonResult{comparator.compare(data->get_label(*edgeId, edge), edge->labelLength, keyOffset)};
+
       if (comparisonResult == FirstTermIsPrefixOfSecondTerm) {
         keyOffset += comparator.mismatchIndex();
-        navigator.goDown();
+        nodeId = edge->outNodeId;
         continue;
       }
       if (comparisonResult == TermsAreEqual) {
-        const auto outNodeId{navigator.edge()->outNodeId};
-        return std::pair<std::size_t, std::size_t>{data->internalToExposedId(outNodeId), outNodeId};
+        return std::pair<std::size_t, std::size_t>{data->internalToExposedId(edge->outNodeId), edge->outNodeId};
       }
       throw StringNotFoundException();
     }
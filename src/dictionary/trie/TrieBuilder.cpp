@@ -0,0 +1,150 @@
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+#include <dictionary/trie/TrieBuilder.hpp>
+
+#include "./DataManager/DataManager.hpp"
+
+namespace csd {
+
+  TrieBuilder::TrieBuilder() {
+    m_internals.push_back({.inEdge = 0, .outEdgesOffset = 0, .numOutEdges = 0});
+  }
+
+  auto TrieBuilder::addOutEdge(const std::size_t& nodeId) -> void {
+    auto& node{m_internals.at(nodeId)};
+    if (node.numOutEdges == std::numeric_limits<decltype(node.numOutEdges)>::max()) {
+      throw std::runtime_error("Too many out-edges for an internal node");
+    }
+    node.numOutEdges++;
+  }
+
+  auto TrieBuilder::add(const std::string& term, const std::size_t& occurrences) -> void {
+    if (term.size() < 2) {
+      throw std::runtime_error("The smallest possible RDF term is 2 characters.");
+    }
+    const std::string key{term + '\0'};
+
+    std::size_t lcp{0};
+    while (lcp < key.size() && lcp < m_previous.size() && key[lcp] == m_previous[lcp]) {
+      lcp++;
+    }
+    if (lcp == key.size() && lcp == m_previous.size()) {
+      m_leaves.back().occurences += occurrences;
+      return;
+    }
+    if (!m_previous.empty() && static_cast<unsigned char>(key[lcp]) < static_cast<unsigned char>(m_previous[lcp])) {
+      throw std::runtime_error("Terms must be added in lexicographic order");
+    }
+
+    // Find the edge of the previous term's path which contains the end of the common prefix.
+    // Edges below it belong to terms which can't receive any more siblings.
+    std::size_t depth{m_previous.size()};
+    std::size_t parentId{0};
+    while (!m_path.empty()) {
+      const auto edgeId{m_path.back()};
+      const auto start{depth - m_edges.at(edgeId).labelLength};
+      if (start > lcp) {
+        m_path.pop_back();
+        depth = start;
+        continue;
+      }
+      if (start == lcp) {
+        // the new term branches off at the node this edge starts from.
+        parentId = m_edges.at(edgeId).inNodeId;
+        m_path.pop_back();
+        break;
+      }
+      // Split the edge:
+      //
+      //   a --e1--> b   =>   a --e1--> x --e2--> b
+      //
+      const auto splitAt{lcp - start};
+      const auto xId{m_internals.size()};
+      const auto e2Id{m_edges.size()};
+      auto e2{m_edges.at(edgeId)};
+      e2.inNodeId = xId;
+      e2.labelOffset += splitAt;
+      e2.labelLength -= splitAt;
+      m_edges.push_back(e2);
+      if (e2.outNodeIsLeaf) {
+        m_leaves.at(e2.outNodeId).inEdge = e2Id;
+      } else {
+        m_internals.at(e2.outNodeId).inEdge = e2Id;
+      }
+      auto& e1{m_edges.at(edgeId)};
+      e1.labelLength = splitAt;
+      e1.outNodeIsLeaf = false;
+      e1.outNodeId = xId;
+      m_internals.push_back({.inEdge = edgeId, .outEdgesOffset = 0, .numOutEdges = 0});
+      addOutEdge(xId);
+      parentId = xId;
+      break;
+    }
+
+    // The rest of the term becomes a new leaf edge. Its label is appended right after the
+    // previous one, so splitting an edge later never needs to move any label bytes.
+    const auto edgeId{m_edges.size()};
+    m_edges.push_back({
+      .outNodeIsLeaf = true,
+      .outNodeId = m_leaves.size(),
+      .inNodeId = parentId,
+      .labelLength = key.size() - lcp,
+      .labelOffset = m_labels.size(),
+      .deleted = false});
+    m_labels.append(key, lcp);
+    m_leaves.push_back({.inEdge = edgeId, .occurences = occurrences});
+    addOutEdge(parentId);
+    m_path.push_back(edgeId);
+    m_previous = key;
+  }
+
+  auto TrieBuilder::numTerms() const -> std::size_t {
+    return m_leaves.size();
+  }
+
+  auto TrieBuilder::save(std::ostream& fp) const -> void {
+    const auto write{[&fp](const auto& value) {
+      fp.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }};
+    const std::size_t numInternalNodes{m_leaves.empty() ? 0 : m_internals.size()};
+    write(DICTIONARY_MAGIC);
+    write(DICTIONARY_VERSION);
+    write(m_leaves.size());
+    write(numInternalNodes);
+    write(m_edges.size());
+    write(m_labels.size());
+    write(std::size_t{0}); // leaf holes
+    write(std::size_t{DictionaryFlags::OrderPreservingIds | DictionaryFlags::OutEdgeFirstBytes});
+
+    fp.write(m_labels.data(), static_cast<std::streamsize>(m_labels.size()));
+    fp.write(reinterpret_cast<const char*>(m_edges.data()), static_cast<std::streamsize>(m_edges.size() * sizeof(Edge)));
+    fp.write(reinterpret_cast<const char*>(m_leaves.data()), static_cast<std::streamsize>(m_leaves.size() * sizeof(LeafNode)));
+
+    // The out-edges of each node are created in the order of their labels,
+    // so grouping the edges by their in-node, in order of their IDs, keeps them sorted.
+    std::vector<std::size_t> offsets(numInternalNodes + 1, 0);
+    for (std::size_t i{0}; i < numInternalNodes; i++) {
+      offsets.at(i + 1) = offsets.at(i) + m_internals.at(i).numOutEdges;
+    }
+    std::vector<std::size_t> outEdgeIds(m_edges.size());
+    auto next{offsets};
+    for (std::size_t edgeId{0}; edgeId < m_edges.size(); edgeId++) {
+      outEdgeIds.at(next.at(m_edges.at(edgeId).inNodeId)++) = edgeId;
+    }
+    fp.write(reinterpret_cast<const char*>(outEdgeIds.data()), static_cast<std::streamsize>(outEdgeIds.size() * sizeof(std::size_t)));
+
+    for (std::size_t i{0}; i < numInternalNodes; i++) {
+      auto node{m_internals.at(i)};
+      node.outEdgesOffset = offsets.at(i);
+      write(node);
+    }
+
+    std::vector<unsigned char> firstBytes(outEdgeIds.size());
+    for (std::size_t i{0}; i < outEdgeIds.size(); i++) {
+      firstBytes.at(i) = m_labels.at(m_edges.at(outEdgeIds.at(i)).labelOffset);
+    }
+    fp.write(reinterpret_cast<const char*>(firstBytes.data()), static_cast<std::streamsize>(firstBytes.size()));
+  }
+}
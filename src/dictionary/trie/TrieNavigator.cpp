@@ -1,6 +1,5 @@
 #include <cstddef>
 #include <stdexcept>
-#include <vector>
 
 #include <dictionary/trie/DataTypes.hpp>
 #include <dictionary/trie/OutEdgeIterator.hpp>
@@ -14,7 +13,7 @@ namespace csd {
       m_upper{nullptr},
       m_lower{nullptr},
       m_edge{nullptr},
-      m_it{new OutEdgeIterator(startingNodeId, data)} {
+      m_it{startingNodeId, data} {
     if (!mayGoRight()) {
       std::cout << startingNodeId << std::endl;
       throw std::runtime_error("Tried to go right but isn't allowed");
@@ -22,12 +21,8 @@ namespace csd {
     goRight();
   }
 
-  TrieNavigator::~TrieNavigator() {
-    delete m_it;
-  }
-
   auto TrieNavigator::mayGoRight() -> bool {
-    return m_it->has_next();
+    return m_it.has_next();
   }
   auto TrieNavigator::mayGoDown() const -> bool {
     return !m_edge->outNodeIsLeaf;
@@ -36,11 +31,8 @@ namespace csd {
     if (!mayGoRight()) {
       throw std::runtime_error("(TrieNavigator::goRight) Tried to go right when its not allowed");
     }
-    if (m_it == nullptr || !m_it->has_next()) {
-      throw std::runtime_error("problem???");
-    }
-    m_edgeId = m_it->read();
-    m_it->proceed();
+    m_edgeId = m_it.read();
+    m_it.proceed();
     m_edge = m_data->get_edge(m_edgeId);
   }
   auto TrieNavigator::goDown() -> void {
@@ -49,8 +41,7 @@ namespace csd {
     }
     m_upper = m_lower;
     m_lower = nullptr;
-    delete m_it;
-    m_it = new OutEdgeIterator(m_edge->outNodeId, m_data);
+    m_it = OutEdgeIterator(m_edge->outNodeId, m_data);
     if (!mayGoRight()) {
       throw std::runtime_error("Not allowed to go right in goDown");
     }
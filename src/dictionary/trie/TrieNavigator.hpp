@@ -6,10 +6,13 @@
 
 namespace csd {
 
+  /**
+   * Walks the out-edges of a node, and down into the out-nodes of its edges.
+   * Keeps no state outside itself, so it doesn't allocate.
+   */
   class TrieNavigator {
   public:
     TrieNavigator(const DataManager* const data, const std::size_t& startingNodeId = 0);
-    ~TrieNavigator();
     auto goRight() -> void;
     auto goDown() -> void;
     auto mayGoRight() -> bool;
@@ -28,7 +31,7 @@ namespace csd {
     InternalNode* m_lower;
     Edge* m_edge;
     std::size_t m_edgeId;
-    OutEdgeIterator* m_it;
+    OutEdgeIterator m_it;
   };
 }
 #endif
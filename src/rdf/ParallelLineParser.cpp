@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#include "./ParallelLineParser.hpp"
+
+namespace {
+  /**
+   * The statements of one chunk, with their terms concatenated in a single string.
+  */
+  struct StatementBatch {
+    std::string terms;
+    /**
+     * The end of each term within `terms`, three per statement.
+    */
+    std::vector<std::size_t> ends;
+  };
+
+  /**
+   * A queue which blocks producers while it is full,
+   * so that the parsers can't run arbitrarily far ahead of the consumer.
+  */
+  class BoundedQueue {
+  public:
+    BoundedQueue(const std::size_t& capacity)
+      : m_capacity{capacity} {
+    }
+    auto push(StatementBatch&& batch) -> void {
+      std::unique_lock lock{m_mutex};
+      m_not_full.wait(lock, [this] { return m_batches.size() < m_capacity; });
+      m_batches.push(std::move(batch));
+      m_not_empty.notify_one();
+    }
+    /**
+     * The next batch, or nothing once all producers are done and the queue is drained.
+    */
+    auto pop() -> std::optional<StatementBatch> {
+      std::unique_lock lock{m_mutex};
+      m_not_empty.wait(lock, [this] { return !m_batches.empty() || m_num_producers == 0; });
+      if (m_batches.empty()) {
+        return std::nullopt;
+      }
+      auto batch{std::move(m_batches.front())};
+      m_batches.pop();
+      m_not_full.notify_one();
+      return batch;
+    }
+    auto add_producer() -> void {
+      std::lock_guard lock{m_mutex};
+      m_num_producers++;
+    }
+    auto remove_producer() -> void {
+      std::lock_guard lock{m_mutex};
+      m_num_producers--;
+      m_not_empty.notify_all();
+    }
+
+  private:
+    const std::size_t m_capacity;
+    std::size_t m_num_producers{0};
+    std::queue<StatementBatch> m_batches;
+    std::mutex m_mutex;
+    std::condition_variable m_not_full;
+    std::condition_variable m_not_empty;
+  };
+}
+
+namespace rdf {
+  ParallelLineParser::ParallelLineParser(const std::filesystem::path& file,
+                                         std::function<void(const std::string& subject, const std::string& predicate, const std::string& object)> callback,
+                                         const std::string& baseIri,
+                                         const rdf::SerializationFormat& format,
+                                         const std::size_t& num_threads,
+                                         const std::size_t& chunk_size) {
+    const auto filesize{std::filesystem::file_size(file)};
+    if (filesize == 0) {
+      return;
+    }
+    const int fd{open(file.c_str(), O_RDONLY)};
+    if (fd == -1) {
+      throw std::runtime_error("Could not open input file for parsing.");
+    }
+    auto* const data{reinterpret_cast<const char*>(mmap(0, filesize, PROT_READ, MAP_SHARED, fd, 0))};
+    if (data == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("Failed to mmap input file: " + file.string());
+    }
+    madvise(const_cast<char*>(data), filesize, MADV_SEQUENTIAL);
+
+    // Chunks are handed out in file order, each ending after a newline (or at the end of the file).
+    std::mutex chunk_mutex;
+    std::size_t chunk_begin{0};
+    const auto next_chunk{[&]() -> std::pair<std::size_t, std::size_t> {
+      std::lock_guard lock{chunk_mutex};
+      const auto begin{chunk_begin};
+      auto end{std::min(begin + std::max<std::size_t>(chunk_size, 1), filesize)};
+      if (end < filesize) {
+        const auto* const newline{static_cast<const char*>(std::memchr(data + end, '\n', filesize - end))};
+        end = newline == nullptr ? filesize : (newline - data) + 1;
+      }
+      chunk_begin = end;
+      return {begin, end};
+    }};
+
+    const auto worker_count{std::max<std::size_t>(num_threads, 1)};
+    BoundedQueue queue{2 * worker_count};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    std::vector<std::thread> workers;
+    for (std::size_t i{0}; i < worker_count; i++) {
+      queue.add_producer();
+      workers.emplace_back([&]() {
+        try {
+          std::string text;
+          while (true) {
+            {
+              std::lock_guard lock{error_mutex};
+              if (error) {
+                break;
+              }
+            }
+            const auto [begin, end]{next_chunk()};
+            if (begin == end) {
+              break;
+            }
+            text.assign(data + begin, end - begin);
+            StatementBatch batch;
+            batch.terms.reserve(text.size());
+            SerdParser::parse_text(
+              text,
+              [&batch](const std::string& subject, const std::string& predicate, const std::string& object) {
+                for (const auto* term: {&subject, &predicate, &object}) {
+                  batch.terms.append(*term);
+                  batch.ends.push_back(batch.terms.size());
+                }
+              },
+              baseIri,
+              format);
+            queue.push(std::move(batch));
+          }
+        } catch (...) {
+          std::lock_guard lock{error_mutex};
+          if (!error) {
+            error = std::current_exception();
+          }
+        }
+        queue.remove_producer();
+      });
+    }
+
+    // Terms are copied into reused strings, which rarely need to allocate.
+    std::string subject;
+    std::string predicate;
+    std::string object;
+    try {
+      while (auto batch{queue.pop()}) {
+        std::size_t begin{0};
+        for (std::size_t i{0}; i < batch->ends.size(); i += 3) {
+          subject.assign(batch->terms, begin, batch->ends[i] - begin);
+          predicate.assign(batch->terms, batch->ends[i], batch->ends[i + 1] - batch->ends[i]);
+          object.assign(batch->terms, batch->ends[i + 1], batch->ends[i + 2] - batch->ends[i + 1]);
+          begin = batch->ends[i + 2];
+          callback(subject, predicate, object);
+        }
+      }
+    } catch (...) {
+      {
+        std::lock_guard lock{error_mutex};
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+      // unblock the workers, which stop at their next chunk.
+      while (queue.pop()) {
+      }
+    }
+    for (auto& worker: workers) {
+      worker.join();
+    }
+    munmap(const_cast<char*>(data), filesize);
+    close(fd);
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  auto parse_file(const std::filesystem::path& file,
+                  std::function<void(const std::string& subject, const std::string& predicate, const std::string& object)> callback,
+                  const std::string& baseIri) -> void {
+    const auto format{format_from_extension(file.extension())};
+    if (ParallelLineParser::supports(file, format)) {
+      ParallelLineParser parser{file, callback, baseIri, format};
+    } else {
+      SerdParser parser{file, callback, baseIri, format};
+    }
+  }
+}
@@ -0,0 +1,49 @@
+#ifndef RDF_PARALLEL_LINE_PARSER_HPP
+#define RDF_PARALLEL_LINE_PARSER_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "./SerdParser.hpp"
+
+namespace rdf {
+  /**
+   * Parses a line-based file (N-Triples or N-Quads) with several threads.
+   * The file is split into chunks at line boundaries, which workers parse independently.
+   * Statements are passed to the callback on the calling thread, in no particular order.
+   */
+  class ParallelLineParser {
+  public:
+    /**
+     * The size of the chunks handed to the workers, before extending them to the next line boundary.
+    */
+    static constexpr std::size_t DEFAULT_CHUNK_SIZE{4 * 1024 * 1024};
+
+    ParallelLineParser(const std::filesystem::path& file,
+                       std::function<void(const std::string& subject, const std::string& predicate, const std::string& object)> callback,
+                       const std::string& baseIri = "https://example.com/",
+                       const rdf::SerializationFormat& format = rdf::SerializationFormat::NTriples,
+                       const std::size_t& num_threads = std::thread::hardware_concurrency(),
+                       const std::size_t& chunk_size = DEFAULT_CHUNK_SIZE);
+
+    /**
+     * Whether files of the given format can be split at line boundaries.
+    */
+    static auto supports(const std::filesystem::path& file, const rdf::SerializationFormat& format) -> bool {
+      return file.extension() != ".gz" && (format == rdf::SerializationFormat::NTriples || format == rdf::SerializationFormat::NQuads);
+    }
+  };
+
+  /**
+   * Parses a file in the format its extension indicates, 
+   * with several threads when the format allows it. 
+  */
+  auto parse_file(const std::filesystem::path& file,
+                  std::function<void(const std::string& subject, const std::string& predicate, const std::string& object)> callback,
+                  const std::string& baseIri = "https://example.com/") -> void;
+}
+
+#endif
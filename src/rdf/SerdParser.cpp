@@ -1,6 +1,8 @@
 #include <cstdint>
+#include <exception>
 #include <filesystem>
 #include <functional>
+#include <memory>
 #include <stdexcept>
 #include <string>
 
@@ -15,46 +17,81 @@ namespace rdf {
                          const std::string& baseIri,
                          const rdf::SerializationFormat& format)
     : m_callback{callback}, m_numByte{std::filesystem::file_size(file)} {
+    read(baseIri, format, [&file](SerdReader* reader) {
+      const std::unique_ptr<std::uint8_t, decltype(&serd_free)> in{serd_file_uri_parse(reinterpret_cast<const std::uint8_t*>(file.c_str()), nullptr), &serd_free};
+      if (file.extension() == ".gz") {
+        LibzSerdStream libzSerdStream{file};
+        const SerdStatus status{serd_reader_read_source(reader,
+                                                        &LibzSerdStream::read,
+                                                        &LibzSerdStream::error,
+                                                        &libzSerdStream,
+                                                        in.get(),
+                                                        4'096)}; //SERD_PAGE_SIZE
+        if (status) {
+          throw std::runtime_error(reinterpret_cast<const char*>(serd_strerror(status)));
+        }
+      } else {
+        FILE* in_fd = fopen(reinterpret_cast<const char*>(in.get()), "r");
+        // TODO: fadvise sequential
+        if (!in_fd) {
+          throw std::runtime_error("Could not open input file for parsing.");
+        }
+        const SerdStatus status{serd_reader_read_file_handle(reader,
+                                                             in_fd,
+                                                             reinterpret_cast<const std::uint8_t*>(file.c_str()))};
+        fclose(in_fd);
+        if (status) {
+          throw std::runtime_error(reinterpret_cast<const char*>(serd_strerror(status)));
+        }
+      }
+    });
+  }
+
+  SerdParser::SerdParser(std::function<void(const std::string& subject, const std::string& predicate, const std::string& object)> callback)
+    : m_callback{callback} {
+  }
+
+  auto SerdParser::parse_text(const std::string& text,
+                              std::function<void(const std::string& subject, const std::string& predicate, const std::string& object)> callback,
+                              const std::string& baseIri,
+                              const rdf::SerializationFormat& format) -> void {
+    SerdParser parser{callback};
+    parser.read(baseIri, format, [&text](SerdReader* reader) {
+      const SerdStatus status{serd_reader_read_string(reader, reinterpret_cast<const std::uint8_t*>(text.c_str()))};
+      if (status) {
+        throw std::runtime_error(reinterpret_cast<const char*>(serd_strerror(status)));
+      }
+    });
+  }
+
+  auto SerdParser::read(const std::string& baseIri, const rdf::SerializationFormat& format, const std::function<void(SerdReader* reader)>& read_source) -> void {
     // Create base IRI and environment.
     SerdURI base_uri{SERD_URI_NULL};
     SerdNode base{serd_node_new_uri_from_string(reinterpret_cast<const std::uint8_t*>(baseIri.c_str()), nullptr, &base_uri)};
+    const std::unique_ptr<SerdNode, decltype(&serd_node_free)> base_owner{&base, &serd_node_free};
     m_environment = serd_env_new(&base);
-    SerdReader* reader = serd_reader_new(parser_type(format),
-                                         this,
-                                         nullptr,
-                                         reinterpret_cast<SerdBaseSink>(on_base),
-                                         reinterpret_cast<SerdPrefixSink>(on_prefix),
-                                         reinterpret_cast<SerdStatementSink>(on_statement),
-                                         nullptr);
-    serd_reader_set_error_sink(reader, on_error, nullptr);
-    std::uint8_t* const in = serd_file_uri_parse(reinterpret_cast<const std::uint8_t*>(file.c_str()), nullptr);
-    if (file.extension() == ".gz") {
-      LibzSerdStream libzSerdStream{file};
-      const SerdStatus status{serd_reader_read_source(reader,
-                                                      &LibzSerdStream::read,
-                                                      &LibzSerdStream::error,
-                                                      &libzSerdStream,
-                                                      in,
-                                                      4'096)}; //SERD_PAGE_SIZE
-      if (status) {
-        throw std::runtime_error(reinterpret_cast<const char*>(serd_strerror(status)));
-      }
-    } else {
-      FILE* in_fd = fopen(reinterpret_cast<const char*>(in), "r");
-      // TODO: fadvise sequential
-      if (!in_fd) {
-        throw std::runtime_error("Could not open input file for parsing.");
+    const std::unique_ptr<SerdEnv, decltype(&serd_env_free)> environment{m_environment, &serd_env_free};
+    const std::unique_ptr<SerdReader, decltype(&serd_reader_free)> reader{
+      serd_reader_new(parser_type(format),
+                      this,
+                      nullptr,
+                      reinterpret_cast<SerdBaseSink>(on_base),
+                      reinterpret_cast<SerdPrefixSink>(on_prefix),
+                      reinterpret_cast<SerdStatementSink>(on_statement),
+                      nullptr),
+      &serd_reader_free};
+    serd_reader_set_error_sink(reader.get(), on_error, this);
+    try {
+      read_source(reader.get());
+    } catch (...) {
+      // The error which made a callback stop the reader says more than the reader's status.
+      if (!m_error) {
+        throw;
       }
-      serd_reader_read_file_handle(reader,
-                                   in_fd,
-                                   reinterpret_cast<const std::uint8_t*>(file.c_str()));
-      fclose(in_fd);
     }
-    serd_free(in);
-    serd_reader_free(reader);
-    serd_env_free(m_environment);
-    serd_node_free(&base);
-    return;
+    if (m_error) {
+      std::rethrow_exception(m_error);
+    }
   }
 
   auto SerdParser::get_string(const SerdEnv* const environment,
@@ -112,14 +149,14 @@ namespace rdf {
     return out;
   }
 
-  auto SerdParser::on_error([[maybe_unused]] void* const handle,
+  auto SerdParser::on_error(void* const handle,
                             const SerdError* const error) -> SerdStatus {
-    std::fprintf(stderr,
-                 "error: %s:%u:%u: ",
-                 error->filename,
-                 error->line,
-                 error->col);
-    throw std::runtime_error("Error parsing input.");
+    SerdParser* const parser = reinterpret_cast<SerdParser*>(handle);
+    if (!parser->m_error) {
+      parser->m_error = std::make_exception_ptr(std::runtime_error(
+        "Error parsing input at "s + (error->filename ? reinterpret_cast<const char*>(error->filename) : "") + ":" +
+        std::to_string(error->line) + ":" + std::to_string(error->col) + "."));
+    }
     return error->status;
   }
 
@@ -147,11 +184,21 @@ namespace rdf {
                                 const SerdNode* const object,
                                 const SerdNode* const datatypeIri,
                                 const SerdNode* const languageTag) -> SerdStatus {
-    const SerdParser* const parser = reinterpret_cast<SerdParser*>(handle);
-    parser->m_callback(
-      parser->get_string(parser->m_environment, subject),
-      parser->get_string(parser->m_environment, predicate),
-      parser->get_string_object(parser->m_environment, object, datatypeIri, languageTag));
+    SerdParser* const parser = reinterpret_cast<SerdParser*>(handle);
+    if (parser->m_error) {
+      return SERD_ERR_UNKNOWN;
+    }
+    // Exceptions must not unwind through the reader, which is C.
+    // The reader is stopped instead, and `read` rethrows once it is cleaned up.
+    try {
+      parser->m_callback(
+        parser->get_string(parser->m_environment, subject),
+        parser->get_string(parser->m_environment, predicate),
+        parser->get_string_object(parser->m_environment, object, datatypeIri, languageTag));
+    } catch (...) {
+      parser->m_error = std::current_exception();
+      return SERD_ERR_UNKNOWN;
+    }
     return SERD_SUCCESS;
   }
 
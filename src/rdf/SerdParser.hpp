@@ -2,8 +2,10 @@
 #define RDF_SERD_PARSER_HPP
 
 #include <cstdint>
+#include <exception>
 #include <filesystem>
 #include <functional>
+#include <stdexcept>
 #include <string>
 
 #include <serd/serd.h>
@@ -17,6 +19,20 @@ namespace rdf {
     TriG,
     Turtle
   };
+  /**
+   * The serialization format of a file, judging by its extension.
+  */
+  inline auto format_from_extension(const std::filesystem::path& extension) -> SerializationFormat {
+    if (extension == ".nq")
+      return rdf::SerializationFormat::NQuads;
+    if (extension == ".nt")
+      return rdf::SerializationFormat::NTriples;
+    if (extension == ".trig")
+      return rdf::SerializationFormat::TriG;
+    if (extension == ".ttl")
+      return rdf::SerializationFormat::Turtle;
+    throw std::runtime_error("Serd parser only supports N-Triples, N-Quads, TriG, and Turtle.");
+  }
   class SerdParser {
   public:
     SerdParser(const std::filesystem::path& file,
@@ -24,6 +40,13 @@ namespace rdf {
                const std::string& baseIri = "https://example.com/",
                const rdf::SerializationFormat& format = rdf::SerializationFormat::NTriples);
     ~SerdParser() = default;
+    /**
+     * Parse a document held in memory, such as a chunk of lines of an N-Triples file. 
+    */
+    static auto parse_text(const std::string& text,
+                           std::function<void(const std::string& subject, const std::string& predicate, const std::string& object)> callback,
+                           const std::string& baseIri = "https://example.com/",
+                           const rdf::SerializationFormat& format = rdf::SerializationFormat::NTriples) -> void;
     static auto on_base(void* handle, const SerdNode* uri) -> SerdStatus;
     static auto on_error(void* handle, const SerdError* error) -> SerdStatus;
     static auto on_prefix(void* handle, const SerdNode* name, const SerdNode* uri) -> SerdStatus;
@@ -37,6 +60,8 @@ namespace rdf {
                              const SerdNode* languageTag) -> SerdStatus;
 
   private:
+    explicit SerdParser(std::function<void(const std::string& subject, const std::string& predicate, const std::string& object)> callback);
+    auto read(const std::string& baseIri, const rdf::SerializationFormat& format, const std::function<void(SerdReader* reader)>& read_source) -> void;
     [[nodiscard]] static auto get_string(const SerdEnv* const environment, const SerdNode* term) -> std::string;
     [[nodiscard]] static auto get_string_object(const SerdEnv* const environment,
                                                 const SerdNode* term,
@@ -44,6 +69,10 @@ namespace rdf {
                                                 const SerdNode* languageTag) -> std::string;
     [[nodiscard]] auto parser_type(const rdf::SerializationFormat& format) -> SerdSyntax;
     SerdEnv* m_environment = nullptr;
+    /**
+     * The first error raised in a callback, which stops the reader.
+    */
+    std::exception_ptr m_error;
     std::uint64_t m_numByte{0};
     std::function<void(const std::string& subject, const std::string& predicate, const std::string& object)> m_callback;
   };
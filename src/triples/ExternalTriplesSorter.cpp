@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "./ExternalTriplesSorter.hpp"
+#include "./TriplesStreamWriter.hpp"
+
+namespace {
+  /**
+   * Triples are stored in run files as their three IDs and quantity.
+   */
+  using RunRecord = std::array<std::size_t, 4>;
+  constexpr std::size_t RECORDS_PER_READ{4096};
+
+  /**
+   * Reads a run file sequentially, a chunk of records at a time.
+   */
+  class RunReader {
+  public:
+    RunReader(const std::filesystem::path& path, const dldi::TripleOrder& order)
+      : m_in{path, std::ios::binary},
+        m_order{order} {
+      if (!m_in.good()) {
+        throw std::runtime_error("Error opening run file: " + path.string());
+      }
+      m_records.reserve(RECORDS_PER_READ);
+      proceed();
+    }
+    auto has_next() const -> bool {
+      return m_has_next;
+    }
+    auto read() const -> const dldi::QuantifiedTriple& {
+      return m_next;
+    }
+    auto key() const -> const std::tuple<std::size_t, std::size_t, std::size_t>& {
+      return m_key;
+    }
+    auto proceed() -> void {
+      if (m_index == m_records.size()) {
+        m_records.resize(RECORDS_PER_READ);
+        m_in.read(reinterpret_cast<char*>(m_records.data()), static_cast<std::streamsize>(m_records.size() * sizeof(RunRecord)));
+        m_records.resize(static_cast<std::size_t>(m_in.gcount()) / sizeof(RunRecord));
+        m_index = 0;
+      }
+      m_has_next = m_index < m_records.size();
+      if (m_has_next) {
+        const auto& record{m_records[m_index++]};
+        m_next = dldi::QuantifiedTriple{record[0], record[1], record[2], record[3]};
+        m_key = m_next.key(m_order);
+      }
+    }
+
+  private:
+    std::ifstream m_in;
+    const dldi::TripleOrder m_order;
+    std::vector<RunRecord> m_records;
+    std::size_t m_index{0};
+    bool m_has_next{false};
+    dldi::QuantifiedTriple m_next{0, 0, 0, 0};
+    std::tuple<std::size_t, std::size_t, std::size_t> m_key;
+  };
+
+  inline auto follows(const std::unique_ptr<RunReader>& lhs, const std::unique_ptr<RunReader>& rhs) -> bool {
+    return rhs->key() < lhs->key();
+  }
+}
+
+namespace dldi {
+  ExternalTriplesSorter::ExternalTriplesSorter(const std::filesystem::path& runs_dir, const dldi::TripleOrder& order, const std::size_t& memory_budget)
+    : m_runs_dir{runs_dir},
+      m_order{order},
+      // sorting needs a scratch buffer as large as the buffered triples, so the buffer gets half of the budget.
+      m_capacity{memory_budget == 0 ? 0 : std::max<std::size_t>(memory_budget / (2 * sizeof(QuantifiedTriple)), 1)} {
+  }
+
+  auto ExternalTriplesSorter::add(const QuantifiedTriple& triple) -> void {
+    m_buffer.add(triple);
+    if (m_capacity > 0 && m_buffer.size() >= m_capacity) {
+      spill();
+    }
+  }
+
+  auto ExternalTriplesSorter::spill() -> void {
+    std::filesystem::create_directories(m_runs_dir);
+    const auto run_path{m_runs_dir / (EnumMapping::order_to_string(m_order) + "-" + std::to_string(m_runs.size()))};
+    std::ofstream out{run_path, std::ios::binary | std::ios::trunc};
+    if (!out.good()) {
+      throw std::runtime_error("Error opening run file: " + run_path.string());
+    }
+    m_buffer.radix_sort(m_order);
+    for (const auto& triple: m_buffer.triples()) {
+      const RunRecord record{triple.subject(), triple.predicate(), triple.object(), triple.quantity()};
+      out.write(reinterpret_cast<const char*>(record.data()), sizeof(record));
+    }
+    m_runs.push_back(run_path);
+    m_buffer = TriplesWriter{};
+  }
+
+  auto ExternalTriplesSorter::save(const std::filesystem::path& path, StatisticsCollector* statistics) -> void {
+    TriplesStreamWriter out{path, m_order, nullptr, statistics};
+    std::optional<QuantifiedTriple> pending;
+    const auto write{[&](const QuantifiedTriple& triple) {
+      if (pending && pending->equals(triple)) {
+        pending->set_quantity(pending->quantity() + triple.quantity());
+        return;
+      }
+      if (pending) {
+        out.write(*pending);
+      }
+      pending = triple;
+    }};
+
+    if (m_runs.empty()) {
+      m_buffer.radix_sort(m_order);
+      for (const auto& triple: m_buffer.triples()) {
+        write(triple);
+      }
+    } else {
+      if (m_buffer.size() > 0) {
+        spill();
+      }
+      std::vector<std::unique_ptr<RunReader>> heap;
+      for (const auto& run: m_runs) {
+        auto reader{std::make_unique<RunReader>(run, m_order)};
+        if (reader->has_next()) {
+          heap.push_back(std::move(reader));
+        }
+      }
+      std::make_heap(heap.begin(), heap.end(), follows);
+      while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), follows);
+        auto& reader{heap.back()};
+        write(reader->read());
+        reader->proceed();
+        if (reader->has_next()) {
+          std::push_heap(heap.begin(), heap.end(), follows);
+        } else {
+          heap.pop_back();
+        }
+      }
+      for (const auto& run: m_runs) {
+        std::filesystem::remove(run);
+      }
+      m_runs.clear();
+    }
+    if (pending) {
+      out.write(*pending);
+    }
+    out.close();
+    m_buffer = TriplesWriter{};
+  }
+}
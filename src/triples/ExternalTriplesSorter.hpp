@@ -0,0 +1,46 @@
+#ifndef DLDI_EXTERNAL_TRIPLES_SORTER_HPP
+#define DLDI_EXTERNAL_TRIPLES_SORTER_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+#include <DLDI_enums.hpp>
+#include <QuantifiedTriple.hpp>
+
+#include "./TriplesWriter.hpp"
+
+namespace dldi {
+
+  /**
+   * Sorts triples in one order with bounded memory.
+   * Whenever the buffered triples exceed the budget, they are sorted and spilled to a run file,
+   * and the runs are merged when saving.
+   */
+  class ExternalTriplesSorter {
+  public:
+    /**
+     * A `memory_budget` of 0 keeps all triples in memory.
+     */
+    ExternalTriplesSorter(const std::filesystem::path& runs_dir, const dldi::TripleOrder& order, const std::size_t& memory_budget = 0);
+    auto add(const QuantifiedTriple& triple) -> void;
+    /**
+     * Write all triples as a triples file, adding up the quantities of equal triples,
+     * and count them in `statistics`, if given. The run files are removed.
+     */
+    auto save(const std::filesystem::path& path, StatisticsCollector* statistics = nullptr) -> void;
+    auto order() const -> dldi::TripleOrder {
+      return m_order;
+    }
+
+  private:
+    auto spill() -> void;
+    std::filesystem::path m_runs_dir;
+    dldi::TripleOrder m_order;
+    std::size_t m_capacity;
+    TriplesWriter m_buffer;
+    std::vector<std::filesystem::path> m_runs;
+  };
+}
+
+#endif
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "./TriplesBlock.hpp"
+
+namespace {
+  // Columns are packed in groups of 64 values, so a group of width W occupies exactly W words.
+  constexpr std::size_t GROUP_SIZE{64};
+  constexpr std::size_t GROUPS_PER_BLOCK{dldi::TRIPLES_PER_BLOCK / GROUP_SIZE};
+  static_assert(dldi::TRIPLES_PER_BLOCK % GROUP_SIZE == 0);
+
+  using Column = std::array<std::uint64_t, dldi::TRIPLES_PER_BLOCK>;
+
+  /**
+   * Unpack one group of 64 values.
+   * The width is a template parameter, so that the loop unrolls into straight-line shifts and masks
+   * which the compiler can vectorize.
+   */
+  template <unsigned Width>
+  inline auto unpack_group(const std::uint64_t* const in, std::uint64_t* const out) -> void {
+    if constexpr (Width == 0) {
+      std::fill_n(out, GROUP_SIZE, 0);
+    } else if constexpr (Width == 64) {
+      std::copy_n(in, GROUP_SIZE, out);
+    } else {
+      constexpr std::uint64_t mask{(std::uint64_t{1} << Width) - 1};
+#pragma GCC unroll 64
+      for (unsigned i = 0; i < GROUP_SIZE; i++) {
+        const unsigned bit{i * Width};
+        const unsigned word{bit / 64};
+        const unsigned shift{bit % 64};
+        std::uint64_t value{in[word] >> shift};
+        if (shift + Width > 64) {
+          value |= in[word + 1] << (64 - shift);
+        }
+        out[i] = value & mask;
+      }
+    }
+  }
+
+  using Unpacker = void (*)(const std::uint64_t* const, std::uint64_t* const);
+
+  template <unsigned... Widths>
+  constexpr auto make_unpackers(std::integer_sequence<unsigned, Widths...>) -> std::array<Unpacker, sizeof...(Widths)> {
+    return {&unpack_group<Widths>...};
+  }
+
+  constexpr auto UNPACKERS{make_unpackers(std::make_integer_sequence<unsigned, 65>{})};
+
+  inline auto pack_column(const Column& values, const std::size_t& num_groups, const unsigned& width, std::ostream& out) -> std::size_t {
+    if (width == 0) {
+      return 0;
+    }
+    std::array<std::uint64_t, GROUPS_PER_BLOCK * 64> words{};
+    for (std::size_t i{0}; i < num_groups * GROUP_SIZE; i++) {
+      const std::size_t bit{i * width};
+      const std::size_t word{bit / 64};
+      const std::size_t shift{bit % 64};
+      words.at(word) |= values.at(i) << shift;
+      if (shift + width > 64) {
+        words.at(word + 1) |= values.at(i) >> (64 - shift);
+      }
+    }
+    const auto num_bytes{num_groups * width * sizeof(std::uint64_t)};
+    out.write(reinterpret_cast<const char*>(words.data()), num_bytes);
+    return num_bytes;
+  }
+
+  /**
+   * For each of subject, predicate and object, the index of the key column which holds it.
+   */
+  inline auto key_columns(const dldi::TripleOrder& order) -> std::array<std::size_t, 3> {
+    if (order == dldi::TripleOrder::SPO)
+      return {0, 1, 2};
+    if (order == dldi::TripleOrder::SOP)
+      return {0, 2, 1};
+    if (order == dldi::TripleOrder::PSO)
+      return {1, 0, 2};
+    if (order == dldi::TripleOrder::POS)
+      return {2, 0, 1};
+    if (order == dldi::TripleOrder::OSP)
+      return {1, 2, 0};
+    throw std::runtime_error("Unrecognized order");
+  }
+}
+
+namespace dldi {
+  auto encode_block(const QuantifiedTriple* triples, const std::size_t& num_triples, const dldi::TripleOrder& order, std::ostream& out) -> std::size_t {
+    if (num_triples == 0 || num_triples > TRIPLES_PER_BLOCK) {
+      throw std::runtime_error("Invalid number of triples for a block");
+    }
+    std::array<Column, 4> columns{};
+    for (std::size_t i{0}; i < num_triples; i++) {
+      const auto key{triples[i].key(order)};
+      if (triples[i].quantity() == 0) {
+        throw std::runtime_error("Tried to encode a triple with quantity 0");
+      }
+      columns[0][i] = std::get<0>(key);
+      columns[1][i] = std::get<1>(key);
+      columns[2][i] = std::get<2>(key);
+      columns[3][i] = triples[i].quantity() - 1;
+    }
+
+    BlockHeader header{};
+    header.first[0] = columns[0][0];
+    header.first[1] = columns[1][0];
+    header.first[2] = columns[2][0];
+    header.num_triples = num_triples;
+
+    // With order-preserving IDs the leading column never decreases, so deltas are small.
+    // Otherwise, fall back to offsets from the smallest value, like the other columns.
+    const auto leading_end{columns[0].begin() + num_triples};
+    if (std::is_sorted(columns[0].begin(), leading_end)) {
+      header.flags |= BlockFlags::DeltaEncodedLeadingColumn;
+      header.base[0] = columns[0][0];
+      for (std::size_t i{num_triples - 1}; i > 0; i--) {
+        columns[0][i] -= columns[0][i - 1];
+      }
+      columns[0][0] = 0;
+    } else {
+      header.base[0] = *std::min_element(columns[0].begin(), leading_end);
+      for (std::size_t i{0}; i < num_triples; i++) {
+        columns[0][i] -= header.base[0];
+      }
+    }
+    for (std::size_t c{1}; c < 3; c++) {
+      header.base[c] = *std::min_element(columns[c].begin(), columns[c].begin() + num_triples);
+      for (std::size_t i{0}; i < num_triples; i++) {
+        columns[c][i] -= header.base[c];
+      }
+    }
+    for (std::size_t c{0}; c < 4; c++) {
+      header.widths[c] = std::bit_width(*std::max_element(columns[c].begin(), columns[c].begin() + num_triples));
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::size_t num_bytes{sizeof(header)};
+    const auto num_groups{(num_triples + GROUP_SIZE - 1) / GROUP_SIZE};
+    for (std::size_t c{0}; c < 4; c++) {
+      num_bytes += pack_column(columns[c], num_groups, header.widths[c], out);
+    }
+    return num_bytes;
+  }
+
+  auto decode_block(const unsigned char* block, const dldi::TripleOrder& order, QuantifiedTriple* out) -> std::size_t {
+    BlockHeader header;
+    std::memcpy(&header, block, sizeof(header));
+    const auto num_triples{static_cast<std::size_t>(header.num_triples)};
+    const auto num_groups{(num_triples + GROUP_SIZE - 1) / GROUP_SIZE};
+
+    std::array<Column, 4> columns;
+    const auto* words{reinterpret_cast<const std::uint64_t*>(block + sizeof(header))};
+    for (std::size_t c{0}; c < 4; c++) {
+      const auto unpack{UNPACKERS.at(header.widths[c])};
+      for (std::size_t g{0}; g < num_groups; g++) {
+        unpack(words, columns[c].data() + g * GROUP_SIZE);
+        words += header.widths[c];
+      }
+    }
+
+    if ((header.flags & BlockFlags::DeltaEncodedLeadingColumn) != 0) {
+      std::uint64_t running{header.base[0]};
+      for (std::size_t i{0}; i < num_triples; i++) {
+        running += columns[0][i];
+        columns[0][i] = running;
+      }
+    } else {
+      for (std::size_t i{0}; i < num_triples; i++) {
+        columns[0][i] += header.base[0];
+      }
+    }
+    for (std::size_t i{0}; i < num_triples; i++) {
+      columns[1][i] += header.base[1];
+      columns[2][i] += header.base[2];
+      columns[3][i] += 1;
+    }
+
+    const auto [s, p, o]{key_columns(order)};
+    for (std::size_t i{0}; i < num_triples; i++) {
+      out[i] = QuantifiedTriple{columns[s][i], columns[p][i], columns[o][i], columns[3][i]};
+    }
+    return num_triples;
+  }
+}
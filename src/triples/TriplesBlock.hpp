@@ -0,0 +1,68 @@
+#ifndef DLDI_TRIPLES_BLOCK_HPP
+#define DLDI_TRIPLES_BLOCK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#include <DLDI_enums.hpp>
+#include <QuantifiedTriple.hpp>
+
+namespace dldi {
+
+  /**
+   * Triples files are split into blocks of this many triples (the last block may hold fewer),
+   * so the block of the n-th triple is found without searching.
+   */
+  constexpr std::size_t TRIPLES_PER_BLOCK{128};
+
+  /**
+   * Layout of a triples file:
+   *
+   *  - TriplesFileHeader
+   *  - the blocks, each a BlockHeader followed by four bit-packed columns
+   *  - the directory, holding the byte offset of each block
+   *  - the fences, holding the key of the first triple of each block.
+   *    They repeat what is in the block headers, but in one place,
+   *    so that finding the block to start a query in doesn't fault in pages of every block.
+   */
+  struct TriplesFileHeader {
+    std::size_t order;
+    std::size_t num_triples;
+    std::size_t num_blocks;
+    std::size_t directory_offset;
+  };
+
+  enum BlockFlags : std::uint8_t {
+    // the first key column holds deltas to the previous triple, rather than offsets from the base.
+    DeltaEncodedLeadingColumn = 1
+  };
+
+  /**
+   * The columns of a block are the three IDs, in the order of the file, and the quantity.
+   * Each column stores values relative to its base, using the column's bit width.
+   * A column in which all values equal the base has width 0, and takes up no space.
+   * This is how quantities are omitted from blocks where they are all 1.
+   */
+  struct BlockHeader {
+    std::size_t first[3]; // key of the first triple
+    std::size_t base[3];
+    std::uint32_t num_triples;
+    std::uint8_t widths[4];
+    std::uint8_t flags;
+  } __attribute__((aligned(8)));
+
+  /**
+   * Write a block of (at most TRIPLES_PER_BLOCK) triples, which are sorted by the given order.
+   * Returns the number of bytes written, which is always a multiple of 8.
+   */
+  auto encode_block(const QuantifiedTriple* triples, const std::size_t& num_triples, const dldi::TripleOrder& order, std::ostream& out) -> std::size_t;
+
+  /**
+   * Decode a whole block into `out`, which must have room for TRIPLES_PER_BLOCK triples.
+   * Returns the number of triples in the block.
+   */
+  auto decode_block(const unsigned char* block, const dldi::TripleOrder& order, QuantifiedTriple* out) -> std::size_t;
+}
+
+#endif
@@ -1,66 +1,80 @@
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <tuple>
 
 #include <DLDI.hpp>
 
+#include "./TriplesBlock.hpp"
 #include "./TriplesReader.hpp"
 
 namespace dldi {
 
-  inline auto find_first_result_index(
-    const QuantifiedTriple* triples,
+  TriplesIterator::TriplesIterator(
+    const TriplesReader& reader,
     const dldi::TriplePattern& pattern,
-    const std::size_t& num_triples,
     const Dictionary& subjects,
     const Dictionary& predicates,
-    const Dictionary& objects) -> std::size_t {
-    const auto order{dldi::DLDI::decide_order_from_triple_pattern(pattern)};
-    if (order == dldi::TripleOrder::SPO)
-      return 0; // match everything
+    const Dictionary& objects)
+    : m_reader{&reader},
+      m_block(TRIPLES_PER_BLOCK),
+      m_block_index{std::numeric_limits<std::size_t>::max()} {
+    std::tie(m_begin, m_end) = reader.range(pattern, subjects, predicates, objects);
+    m_index = m_begin;
+    update_next();
+  }
 
-    std::size_t lower_bound{0};
-    std::size_t upper_bound{num_triples - 1};
-    while (true) {
-      const std::size_t i{((upper_bound - lower_bound) / 2) + lower_bound};
-      if (triples[i].matched_by(pattern)) {
-        upper_bound = i;
-        if (upper_bound == lower_bound)
-          return i;
-      } else if (triples[i].precedes(pattern, order, subjects, predicates, objects)) {
-        lower_bound = i + 1;
-      } else {
-        upper_bound = i - 1;
-      }
-    }
+  auto TriplesIterator::range() const -> std::pair<std::size_t, std::size_t> {
+    return {m_begin, m_end};
+  }
+  auto TriplesIterator::count() const -> std::size_t {
+    return m_end - m_begin;
+  }
 
-    return 0;
+  auto TriplesIterator::load_block(const std::size_t& block) -> void {
+    m_block.resize(TRIPLES_PER_BLOCK);
+    m_block.resize(m_reader->decode_block(block, m_block.data()));
+    m_block_index = block;
   }
 
-  TriplesIterator::TriplesIterator(
-    const QuantifiedTriple* triples,
-    const dldi::TriplePattern& pattern,
-    const std::size_t& num_triples,
-    const Dictionary& subjects,
-    const Dictionary& predicates,
-    const Dictionary& objects)
-    : m_triples{triples}, m_pattern{pattern}, m_index{0}, m_num_triples{num_triples} {
-    assert(subjects != nullptr && predicates != nullptr && objects != nullptr);
+  auto TriplesIterator::update_next() -> void {
+    m_has_next = m_index < m_end;
+    if (!m_has_next) {
+      return;
+    }
+    const auto block{m_index / TRIPLES_PER_BLOCK};
+    if (block != m_block_index) {
+      load_block(block);
+    }
+    m_next = m_block.at(m_index % TRIPLES_PER_BLOCK);
+  }
 
-    const auto first_result_index{find_first_result_index(triples, pattern, num_triples, subjects, predicates, objects)};
-    // std::cout << "first_result_index : " << first_result_index << std::endl;
-    m_index = first_result_index;
-    m_has_next = m_index < num_triples && m_triples[m_index].matched_by(pattern);
-    if (m_has_next) {
-      m_next = m_triples[m_index];
-      // m_triples[m_index].print();
-      // std::cout << std::endl;
+  auto TriplesIterator::next_batch(std::span<QuantifiedTriple> out) -> std::size_t {
+    std::size_t written{0};
+    while (written < out.size() && m_index < m_end) {
+      const auto block{m_index / TRIPLES_PER_BLOCK};
+      const auto offset{m_index % TRIPLES_PER_BLOCK};
+      const auto available{std::min(m_end, (block + 1) * TRIPLES_PER_BLOCK) - m_index};
+      if (offset == 0 && available == TRIPLES_PER_BLOCK && out.size() - written >= TRIPLES_PER_BLOCK && block != m_block_index) {
+        m_reader->decode_block(block, out.data() + written);
+        written += TRIPLES_PER_BLOCK;
+        m_index += TRIPLES_PER_BLOCK;
+        continue;
+      }
+      if (block != m_block_index) {
+        load_block(block);
+      }
+      const auto n{std::min(available, out.size() - written)};
+      std::copy_n(m_block.begin() + offset, n, out.begin() + written);
+      written += n;
+      m_index += n;
     }
+    update_next();
+    return written;
   }
 
   auto TriplesIterator::inner_proceed() -> void {
     ++m_index;
-    m_has_next = m_index < m_num_triples && m_triples[m_index].matched_by(m_pattern);
-    if (m_has_next) {
-      m_next = m_triples[m_index];
-    }
+    update_next();
   }
 }
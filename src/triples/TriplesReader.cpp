@@ -1,12 +1,17 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <execution>
 #include <fcntl.h>
 #include <fstream>
 #include <iostream>
+#include <ranges>
 #include <sys/mman.h>
 #include <unistd.h>
 
 #include <DLDI.hpp>
 
+#include "./TriplesBlock.hpp"
 #include "./TriplesReader.hpp"
 
 namespace dldi {
@@ -17,27 +22,108 @@ namespace dldi {
       throw std::runtime_error("Failed to open file for reading " + path.string());
     }
 
-    const auto filesize{std::filesystem::file_size(path)};
-    m_num_triples = filesize / (sizeof(QuantifiedTriple));
+    m_filesize = std::filesystem::file_size(path);
+    if (m_filesize < sizeof(TriplesFileHeader)) {
+      close(fd);
+      throw std::runtime_error("Not a triples file: " + path.string());
+    }
 
-    m_triples = reinterpret_cast<const QuantifiedTriple*>(mmap(0, filesize, PROT_READ, MAP_SHARED, fd, 0));
-    if (m_triples == MAP_FAILED) {
+    m_data = reinterpret_cast<const unsigned char*>(mmap(0, m_filesize, PROT_READ, MAP_SHARED, fd, 0));
+    if (m_data == MAP_FAILED) {
+      close(fd);
       throw std::runtime_error("Failed to mmap triples file: " + path.string());
     };
+
+    TriplesFileHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+    // the directory holds an offset and a fence of three IDs per block.
+    if (header.directory_offset + header.num_blocks * 4 * sizeof(std::size_t) != m_filesize) {
+      munmap(const_cast<unsigned char*>(m_data), m_filesize);
+      close(fd);
+      throw std::runtime_error("Corrupt triples file: " + path.string());
+    }
+    m_order = static_cast<dldi::TripleOrder>(header.order);
+    m_num_triples = header.num_triples;
+    m_num_blocks = header.num_blocks;
+    m_block_offsets = reinterpret_cast<const std::size_t*>(m_data + header.directory_offset);
+    load_fences(m_block_offsets + m_num_blocks);
+  }
+
+  auto TriplesReader::load_fences(const std::size_t* fences) -> void {
+    m_fences.reserve(m_num_blocks);
+    for (std::size_t block{0}; block < m_num_blocks; block++) {
+      const auto* const fence{fences + 3 * block};
+      const std::tuple<std::size_t, std::size_t, std::size_t> key{fence[0], fence[1], fence[2]};
+      // fences don't record quantities.
+      m_fences.push_back(QuantifiedTriple::from_key(key, m_order, 0));
+    }
   }
 
   TriplesReader::~TriplesReader() {
+    munmap(const_cast<unsigned char*>(m_data), m_filesize);
     close(fd);
   }
 
   auto TriplesReader::query(const dldi::TriplePattern& pattern, const Dictionary& subjects, const Dictionary& predicates, const Dictionary& objects) -> TriplesIterator {
-    return TriplesIterator{m_triples, pattern, m_num_triples, subjects, predicates, objects};
+    return TriplesIterator{*this, pattern, subjects, predicates, objects};
   }
   auto TriplesReader::query_ptr(const dldi::TriplePattern& pattern, const Dictionary& subjects, const Dictionary& predicates, const Dictionary& objects) const -> std::shared_ptr<TriplesIterator> {
-    return std::make_shared<TriplesIterator>(m_triples, pattern, m_num_triples, subjects, predicates, objects);
+    return std::make_shared<TriplesIterator>(*this, pattern, subjects, predicates, objects);
+  }
+
+  /**
+   * The position of the first triple for which `before` doesn't hold, 
+   * given that it holds for a prefix of the file. 
+  */
+  inline auto partition_point(const TriplesReader& reader, const auto& before) -> std::size_t {
+    // The first block which doesn't start before the partition point.
+    // The partition point is in the preceding block, or at the start of this one.
+    const auto blocks{std::views::iota(std::size_t{0}, reader.num_blocks())};
+    const auto block{*std::ranges::partition_point(blocks, [&](const std::size_t& block) {
+      return before(reader.first_of_block(block));
+    })};
+    if (block == 0) {
+      return 0;
+    }
+    std::array<QuantifiedTriple, TRIPLES_PER_BLOCK> triples;
+    const auto num_triples{reader.decode_block(block - 1, triples.data())};
+    const auto* const point{std::partition_point(triples.data(), triples.data() + num_triples, before)};
+    return (block - 1) * TRIPLES_PER_BLOCK + (point - triples.data());
   }
 
-  auto TriplesReader::num_triples() -> std::size_t {
+  auto TriplesReader::range(const dldi::TriplePattern& pattern, const Dictionary& subjects, const Dictionary& predicates, const Dictionary& objects) const -> std::pair<std::size_t, std::size_t> {
+    if (std::get<0>(pattern) == 0 && std::get<1>(pattern) == 0 && std::get<2>(pattern) == 0) {
+      return {0, m_num_triples};
+    }
+    // only the dictionaries of fixed positions are used (or necessarily loaded).
+    const auto order_preserving_ids{
+      (std::get<0>(pattern) == 0 || subjects.has_order_preserving_ids()) &&
+      (std::get<1>(pattern) == 0 || predicates.has_order_preserving_ids()) &&
+      (std::get<2>(pattern) == 0 || objects.has_order_preserving_ids())};
+    const auto compare{[&](const QuantifiedTriple& triple) {
+      // with order-preserving IDs, we can binary search without looking terms up in the dictionaries.
+      return order_preserving_ids ? triple.compare_to(pattern, m_order) : triple.compare_to(pattern, m_order, subjects, predicates, objects);
+    }};
+    const auto begin{partition_point(*this, [&](const QuantifiedTriple& triple) { return compare(triple) < 0; })};
+    const auto end{partition_point(*this, [&](const QuantifiedTriple& triple) { return compare(triple) <= 0; })};
+    return {begin, end};
+  }
+
+  auto TriplesReader::num_triples() const -> std::size_t {
     return m_num_triples;
   }
+  auto TriplesReader::num_blocks() const -> std::size_t {
+    return m_num_blocks;
+  }
+  auto TriplesReader::order() const -> dldi::TripleOrder {
+    return m_order;
+  }
+
+  auto TriplesReader::first_of_block(const std::size_t& block) const -> const QuantifiedTriple& {
+    return m_fences[block];
+  }
+
+  auto TriplesReader::decode_block(const std::size_t& block, QuantifiedTriple* out) const -> std::size_t {
+    return dldi::decode_block(m_data + m_block_offsets[block], m_order, out);
+  }
 }
@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <utility>
 
 #include <DLDI_enums.hpp>
 #include <dictionary/Dictionary.hpp>
@@ -19,7 +20,24 @@ namespace dldi {
     ~TriplesReader();
     auto query(const dldi::TriplePattern& pattern, const Dictionary& subjects, const Dictionary& predicates, const Dictionary& objects) -> dldi::TriplesIterator;
     auto query_ptr(const dldi::TriplePattern& pattern, const Dictionary& subjects, const Dictionary& predicates, const Dictionary& objects) const -> std::shared_ptr<dldi::TriplesIterator>;
-    auto num_triples() -> std::size_t;
+    /**
+     * The positions [begin, end) of the triples which match the pattern, 
+     * found by binary searches for the first match and the first triple past the matches. 
+     * The pattern's fixed terms must form a prefix of this file's order. 
+    */
+    auto range(const dldi::TriplePattern& pattern, const Dictionary& subjects, const Dictionary& predicates, const Dictionary& objects) const -> std::pair<std::size_t, std::size_t>;
+    auto num_triples() const -> std::size_t;
+    auto num_blocks() const -> std::size_t;
+    auto order() const -> dldi::TripleOrder;
+    /**
+     * The first triple of a block, from the in-memory fences.
+    */
+    auto first_of_block(const std::size_t& block) const -> const dldi::QuantifiedTriple&;
+    /**
+     * Decode a block into `out`, which must have room for TRIPLES_PER_BLOCK triples. 
+     * Returns the number of triples in the block. 
+    */
+    auto decode_block(const std::size_t& block, dldi::QuantifiedTriple* out) const -> std::size_t;
 
     static auto triples_file_path(const std::filesystem::path& dldi_dir, const dldi::TripleOrder& order) -> std::filesystem::path {
       return dldi_dir.string() + "/" + EnumMapping::order_to_string(order) + ".triples";
@@ -34,10 +52,16 @@ namespace dldi {
       }
     }
   private:
-    const dldi::QuantifiedTriple* m_triples;
+    auto load_fences(const std::size_t* fences) -> void;
+    const unsigned char* m_data;
+    const std::size_t* m_block_offsets;
     int fd;
+    std::size_t m_filesize;
     std::size_t m_num_triples;
+    std::size_t m_num_blocks;
+    dldi::TripleOrder m_order;
+    std::vector<dldi::QuantifiedTriple> m_fences;
   };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,75 @@
+#include <stdexcept>
+
+#include "./TriplesBlock.hpp"
+#include "./TriplesStreamWriter.hpp"
+
+namespace dldi {
+  TriplesStreamWriter::TriplesStreamWriter(const std::filesystem::path& outpath, const dldi::TripleOrder& order, WriteThrottle* throttle, StatisticsCollector* statistics)
+    : m_out{outpath, std::ios::binary | std::ios::trunc},
+      m_order{order},
+      m_throttle{throttle},
+      m_statistics{statistics},
+      m_num_triples{0},
+      m_offset{sizeof(TriplesFileHeader)} {
+    if (!m_out.good()) {
+      throw std::runtime_error("Error opening file to save triples: " + outpath.string());
+    }
+    m_block.reserve(TRIPLES_PER_BLOCK);
+    // reserve room for the header, which is written once the counts are known.
+    const TriplesFileHeader header{};
+    m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+
+  TriplesStreamWriter::~TriplesStreamWriter() {
+    // without a call to close(), the file is left without a valid header.
+    if (m_out.is_open()) {
+      m_out.close();
+    }
+  }
+
+  auto TriplesStreamWriter::write(const QuantifiedTriple& triple) -> void {
+    if (triple.subject() == 0 || triple.predicate() == 0 || triple.object() == 0) {
+      throw std::runtime_error("Tried to save invalid triple. Implementation error.");
+    }
+    m_block.push_back(triple);
+    m_num_triples++;
+    if (m_statistics != nullptr) {
+      m_statistics->add(m_order, triple);
+    }
+    if (m_block.size() == TRIPLES_PER_BLOCK) {
+      flush_block();
+    }
+  }
+
+  auto TriplesStreamWriter::flush_block() -> void {
+    if (m_block.empty()) {
+      return;
+    }
+    m_block_offsets.push_back(m_offset);
+    const auto [first, second, third]{m_block.front().key(m_order)};
+    m_fences.insert(m_fences.end(), {first, second, third});
+    const auto block_size{encode_block(m_block.data(), m_block.size(), m_order, m_out)};
+    m_offset += block_size;
+    m_block.clear();
+    if (m_throttle != nullptr) {
+      m_throttle->wrote(block_size);
+    }
+  }
+
+  auto TriplesStreamWriter::close() -> void {
+    flush_block();
+    const TriplesFileHeader header{
+      .order = static_cast<std::size_t>(m_order),
+      .num_triples = m_num_triples,
+      .num_blocks = m_block_offsets.size(),
+      .directory_offset = m_offset};
+    m_out.write(reinterpret_cast<const char*>(m_block_offsets.data()), m_block_offsets.size() * sizeof(std::size_t));
+    m_out.write(reinterpret_cast<const char*>(m_fences.data()), m_fences.size() * sizeof(std::size_t));
+    m_out.seekp(0);
+    m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_out.close();
+    if (m_out.fail()) {
+      throw std::runtime_error("Error writing triples file");
+    }
+  }
+}
@@ -0,0 +1,47 @@
+#ifndef DLDI_TRIPLES_STREAM_WRITER_HPP
+#define DLDI_TRIPLES_STREAM_WRITER_HPP
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <DLDI_enums.hpp>
+#include <QuantifiedTriple.hpp>
+#include <Statistics.hpp>
+#include <WriteThrottle.hpp>
+
+namespace dldi {
+
+  /**
+   * Writes a triples file from triples which arrive sorted by the file's order,
+   * encoding them block by block.
+   * The first key of every block is also kept, to be written after the block directory.
+   * With a throttle, every block is accounted for as it is written.
+   * With a statistics collector, every triple is counted as it is written.
+   */
+  class TriplesStreamWriter {
+  public:
+    TriplesStreamWriter(const std::filesystem::path& outpath, const dldi::TripleOrder& order, WriteThrottle* throttle = nullptr, StatisticsCollector* statistics = nullptr);
+    ~TriplesStreamWriter();
+    auto write(const QuantifiedTriple& triple) -> void;
+    /**
+     * Write the remaining triples, the block directory, the fences and the file header.
+     * Must be called for the file to be readable.
+     */
+    auto close() -> void;
+
+  private:
+    auto flush_block() -> void;
+    std::ofstream m_out;
+    const dldi::TripleOrder m_order;
+    WriteThrottle* m_throttle;
+    StatisticsCollector* m_statistics;
+    std::vector<QuantifiedTriple> m_block;
+    std::vector<std::size_t> m_block_offsets;
+    std::vector<std::size_t> m_fences;
+    std::size_t m_num_triples;
+    std::size_t m_offset;
+  };
+}
+
+#endif
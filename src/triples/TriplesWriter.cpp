@@ -1,36 +1,22 @@
+#include <algorithm>
+#include <array>
 #include <execution>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <utility>
 
+#include "./TriplesStreamWriter.hpp"
 #include "./TriplesWriter.hpp"
 
 namespace dldi {
-  class TriplesComparator_lex {
-  public:
-    TriplesComparator_lex(const Dictionary& subjects, const Dictionary& predicates, const Dictionary& objects, const dldi::TripleOrder& order)
-      : m_subjects{subjects}, m_predicates{predicates}, m_objects{objects}, m_order{order} {
+  inline auto remapped(const QuantifiedTriple& triple, const IdMapping& subjects, const IdMapping& predicates, const IdMapping& objects) -> QuantifiedTriple {
+    const QuantifiedTriple result{subjects.at(triple.subject()), predicates.at(triple.predicate()), objects.at(triple.object()), triple.quantity()};
+    if (result.subject() == 0 || result.predicate() == 0 || result.object() == 0) {
+      throw std::runtime_error("Triple refers to a term which is not in the dictionary");
     }
-
-    [[nodiscard]] auto operator()(const QuantifiedTriple& lhs, const QuantifiedTriple& rhs) -> bool {
-      if (lhs.subject() == 0 || rhs.subject() == 0) {
-        throw std::runtime_error("Invalid triple (sub)");
-      }
-      if (lhs.predicate() == 0 || rhs.predicate() == 0) {
-        throw std::runtime_error("Invalid triple (pred)");
-      }
-      if (lhs.object() == 0 || rhs.object() == 0) {
-        throw std::runtime_error("Invalid triple (obj)");
-      }
-
-      return lhs.smaller_or_equal_to(rhs, m_order, m_subjects, m_predicates, m_objects);
-    }
-
-  private:
-    const Dictionary& m_subjects;
-    const Dictionary& m_predicates;
-    const Dictionary& m_objects;
-    const dldi::TripleOrder& m_order;
-  };
+    return result;
+  }
 
   auto TriplesWriter::add(const std::size_t& subject, const std::size_t& predicate, const std::size_t& object) -> void {
     if (subject == 0 || predicate == 0 || object == 0) {
@@ -39,24 +25,136 @@ namespace dldi {
     m_triples.push_back(QuantifiedTriple{subject, predicate, object, 1});
   }
 
-  auto TriplesWriter::sort(const dldi::Dictionary& subjects, const dldi::Dictionary& predicates, const dldi::Dictionary& objects, const dldi::TripleOrder& order) -> void {
-    const auto comparator{TriplesComparator_lex(subjects, predicates, objects, order)};
-    std::sort(m_triples.begin(), m_triples.end(), comparator);
+  auto TriplesWriter::add(const QuantifiedTriple& triple) -> void {
+    if (triple.subject() == 0 || triple.predicate() == 0 || triple.object() == 0) {
+      throw std::runtime_error("Tried to add an invalid triple");
+    }
+    m_triples.push_back(triple);
+  }
+
+  auto TriplesWriter::size() const -> std::size_t {
+    return m_triples.size();
+  }
+
+  auto TriplesWriter::memory_usage() const -> std::size_t {
+    return (m_triples.capacity() + m_triples.size()) * sizeof(QuantifiedTriple);
   }
-  auto TriplesWriter::save(const std::filesystem::path& path) -> void {
-    std::ofstream out{path, std::ios::binary | std::ios::trunc};
-    if (!out.good()) {
-      throw std::runtime_error("Error opening file to save dictionary");
+
+  auto TriplesWriter::remap(const IdMapping& subjects, const IdMapping& predicates, const IdMapping& objects) -> void {
+    for (auto& triple: m_triples) {
+      triple = remapped(triple, subjects, predicates, objects);
     }
+  }
 
-    for (const auto& triple: m_triples) {
-      if (triple.quantity() == 0) {
+  auto TriplesWriter::triples() const -> const std::vector<QuantifiedTriple>& {
+    return m_triples;
+  }
+
+  /**
+   * Run `f(thread, begin, end)` on each thread's share of `size` items, and wait for all of them. 
+  */
+  template <typename F>
+  inline auto for_each_share(const std::size_t& num_threads, const std::size_t& size, F&& f) -> void {
+    const auto share{(size + num_threads - 1) / num_threads};
+    std::vector<std::future<void>> futures;
+    for (std::size_t thread{1}; thread < num_threads; thread++) {
+      futures.push_back(std::async(std::launch::async, [&f, thread, share, size]() {
+        f(thread, std::min(thread * share, size), std::min((thread + 1) * share, size));
+      }));
+    }
+    f(0, 0, std::min(share, size));
+    for (auto& future: futures) {
+      future.get();
+    }
+  }
+
+  auto TriplesWriter::radix_sort(const dldi::TripleOrder& order, const std::size_t& num_threads) -> void {
+    // LSD radix sort over the bytes of the key, least significant column first.
+    constexpr std::size_t RADIX{256};
+    constexpr std::size_t DIGITS_PER_ID{sizeof(std::size_t)};
+    constexpr std::size_t NUM_PASSES{3 * DIGITS_PER_ID};
+    // below this many triples per thread, starting threads costs more than it saves.
+    constexpr std::size_t MIN_TRIPLES_PER_THREAD{1 << 16};
+    using Histogram = std::array<std::size_t, RADIX>;
+    const auto positions{QuantifiedTriple::key_positions(order)};
+    const auto digit{[&positions](const QuantifiedTriple& triple, const std::size_t& pass) -> std::size_t {
+      const auto column{2 - pass / DIGITS_PER_ID};
+      return (triple.term(positions[column]) >> (8 * (pass % DIGITS_PER_ID))) & (RADIX - 1);
+    }};
+    const auto threads{std::clamp<std::size_t>(m_triples.size() / MIN_TRIPLES_PER_THREAD, 1, std::max<std::size_t>(num_threads, 1))};
+
+    // Histograms for all passes in one scan.
+    // The digits don't change between passes, so these tell which passes would move nothing.
+    std::vector<std::array<Histogram, NUM_PASSES>> thread_histograms(threads);
+    for_each_share(threads, m_triples.size(), [&](const std::size_t& thread, const std::size_t& begin, const std::size_t& end) {
+      auto& histograms{thread_histograms[thread]};
+      for (auto& histogram: histograms) {
+        histogram.fill(0);
+      }
+      for (auto i{begin}; i < end; i++) {
+        for (std::size_t pass{0}; pass < NUM_PASSES; pass++) {
+          histograms[pass][digit(m_triples[i], pass)]++;
+        }
+      }
+    });
+
+    std::vector<QuantifiedTriple> scratch(m_triples.size());
+    // where each thread scatters the triples of its share, by digit.
+    std::vector<Histogram> offsets(threads);
+    for (std::size_t pass{0}; pass < NUM_PASSES; pass++) {
+      Histogram total{};
+      for (const auto& histograms: thread_histograms) {
+        for (std::size_t d{0}; d < RADIX; d++) {
+          total[d] += histograms[pass][d];
+        }
+      }
+      // a pass where all triples share the digit wouldn't move anything.
+      if (std::ranges::any_of(total, [this](const std::size_t& count) { return count == m_triples.size(); })) {
         continue;
       }
-      if (triple.subject() == 0 || triple.predicate() == 0 || triple.object() == 0) {
-        throw std::runtime_error("Tried to save invalid triple. Implementation error.");
+      // Each share's histogram of this pass's digit depends on where the previous pass left the triples.
+      if (threads > 1) {
+        for_each_share(threads, m_triples.size(), [&](const std::size_t& thread, const std::size_t& begin, const std::size_t& end) {
+          auto& histogram{offsets[thread]};
+          histogram.fill(0);
+          for (auto i{begin}; i < end; i++) {
+            histogram[digit(m_triples[i], pass)]++;
+          }
+        });
+      } else {
+        offsets[0] = total;
+      }
+      // triples with a smaller digit come first, and for the same digit, those of earlier shares, which keeps the sort stable.
+      std::size_t offset{0};
+      for (std::size_t d{0}; d < RADIX; d++) {
+        for (auto& histogram: offsets) {
+          offset += std::exchange(histogram[d], offset);
+        }
+      }
+      for_each_share(threads, m_triples.size(), [&](const std::size_t& thread, const std::size_t& begin, const std::size_t& end) {
+        auto& histogram{offsets[thread]};
+        for (auto i{begin}; i < end; i++) {
+          scratch[histogram[digit(m_triples[i], pass)]++] = m_triples[i];
+        }
+      });
+      std::swap(m_triples, scratch);
+    }
+  }
+
+  auto TriplesWriter::save_sorted(const std::filesystem::path& path, const dldi::TripleOrder& order, const std::size_t& num_threads, StatisticsCollector* statistics) -> void {
+    radix_sort(order, num_threads);
+    TriplesStreamWriter out{path, order, nullptr, statistics};
+    // repeated statements are adjacent once sorted, and are written once with their summed quantity.
+    const auto& triples{m_triples};
+    for (std::size_t i{0}; i < triples.size();) {
+      auto triple{triples[i]};
+      for (i++; i < triples.size() && triples[i].subject() == triple.subject() && triples[i].predicate() == triple.predicate() && triples[i].object() == triple.object(); i++) {
+        triple = QuantifiedTriple{triple.subject(), triple.predicate(), triple.object(), triple.quantity() + triples[i].quantity()};
+      }
+      if (triple.quantity() == 0) {
+        continue;
       }
-      out.write(reinterpret_cast<const char*>(&triple), sizeof(triple));
+      out.write(triple);
     }
     out.close();
   }
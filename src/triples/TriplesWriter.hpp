@@ -17,12 +17,32 @@ namespace dldi {
     TriplesWriter(const std::filesystem::path& outpath);
 
     auto add(const std::size_t& subject, const std::size_t& predicate, const std::size_t& object) -> void;
-    auto sort(const dldi::Dictionary& subjects, const dldi::Dictionary& predicates, const dldi::Dictionary& objects, const dldi::TripleOrder& order) -> void;
-    auto save(const std::filesystem::path& path) -> void;
+    auto add(const QuantifiedTriple& triple) -> void;
+    auto size() const -> std::size_t;
+    /**
+     * The memory of the triples, and of the scratch buffer which sorting them takes. 
+    */
+    auto memory_usage() const -> std::size_t;
+    /**
+     * Translate the IDs of all triples, e.g. to those of an order-preserving dictionary save. 
+    */
+    auto remap(const dldi::IdMapping& subjects, const dldi::IdMapping& predicates, const dldi::IdMapping& objects) -> void;
+    auto triples() const -> const std::vector<QuantifiedTriple>&;
+    /**
+     * Radix sort the triples by ID in the given order, in place. 
+     * This is a lexicographic sort as long as the IDs are order-preserving. 
+     * The threads split the triples between them, and share one scratch buffer as large as the triples. 
+    */
+    auto radix_sort(const dldi::TripleOrder& order, const std::size_t& num_threads = 1) -> void;
+    /**
+     * Sort the triples in the given order and save them as a triples file of that order. 
+     * Repeated triples are saved once, with their quantities summed, and counted by `statistics`, if given. 
+    */
+    auto save_sorted(const std::filesystem::path& path, const dldi::TripleOrder& order, const std::size_t& num_threads = 1, StatisticsCollector* statistics = nullptr) -> void;
 
   private:
     std::vector<QuantifiedTriple> m_triples;
   };
 }
 
-#endif
\ No newline at end of file
+#endif
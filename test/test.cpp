@@ -1,8 +1,23 @@
 #include <catch2/catch_all.hpp>
+#include <algorithm>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <tuple>
 #include <vector>
 
 #include <DLDI.hpp>
+#include <DLDIView.hpp>
+#include <Compactor.hpp>
+#include <WriteThrottle.hpp>
+#include <dictionary/trie/TrieBuilder.hpp>
+
+#include "../src/dictionary/ExternalTermSorter.hpp"
+#include "../src/dictionary/TermEncodingCache.hpp"
+#include "../src/rdf/ParallelLineParser.hpp"
+#include "../src/triples/TriplesWriter.hpp"
 
 // NB: avoid file path conflicts across tests.
 // Tests are run in parallel.
@@ -20,6 +35,60 @@ inline auto temporary_directory(const std::filesystem::path& base) -> std::files
   return std::filesystem::path{mkdtemp_result};
 }
 
+/**
+ * 300 distinct triples: 20 subjects, each with 3 predicates, each with 5 objects. 
+*/
+inline auto write_many_triples(const std::filesystem::path& path) -> void {
+  std::ofstream ptld{path};
+  for (auto s{0}; s < 20; s++) {
+    for (auto p{0}; p < 3; p++) {
+      for (auto o{0}; o < 5; o++) {
+        ptld << "<http://example.com/s" << s << "> <http://example.com/p" << p << "> \"" << o * 1000 << "\" .\n";
+      }
+    }
+  }
+}
+
+/**
+ * The triples of a DLDI in the given order, as their terms and quantity. 
+*/
+inline auto all_statements(const std::filesystem::path& path, const dldi::TripleOrder& order) -> std::vector<std::string> {
+  dldi::DLDI dldi{path};
+  dldi.ensure_loaded(dldi::TripleTermPosition::subject);
+  dldi.ensure_loaded(dldi::TripleTermPosition::predicate);
+  dldi.ensure_loaded(dldi::TripleTermPosition::object);
+  dldi.ensure_loaded_triples(order);
+  std::vector<std::string> result;
+  auto it{dldi.query_ptr(order)};
+  while (it->has_next()) {
+    const auto triple{it->read()};
+    result.push_back(dldi.id_to_string(triple.subject(), dldi::TripleTermPosition::subject) + " " +
+                     dldi.id_to_string(triple.predicate(), dldi::TripleTermPosition::predicate) + " " +
+                     dldi.id_to_string(triple.object(), dldi::TripleTermPosition::object) + " " +
+                     std::to_string(triple.quantity()));
+    it->proceed();
+  }
+  return result;
+}
+
+/**
+ * The triples of a view in the given order, like `all_statements` of a DLDI. 
+*/
+inline auto all_statements(dldi::DLDIView& view, const dldi::TripleOrder& order) -> std::vector<std::string> {
+  view.ensure_loaded_triples(order);
+  std::vector<std::string> result;
+  auto it{view.query_ptr(order)};
+  while (it->has_next()) {
+    const auto triple{it->read()};
+    result.push_back(view.id_to_string(triple.subject(), dldi::TripleTermPosition::subject) + " " +
+                     view.id_to_string(triple.predicate(), dldi::TripleTermPosition::predicate) + " " +
+                     view.id_to_string(triple.object(), dldi::TripleTermPosition::object) + " " +
+                     std::to_string(triple.quantity()));
+    it->proceed();
+  }
+  return result;
+}
+
 TEST_CASE("Creating DLDIs from plain-text linked data") {
   const auto tmpdir{temporary_directory("create")};
 
@@ -47,6 +116,109 @@ TEST_CASE("Should compose from files to add and remove") {
                       tmpdir / "merged.dldi");
 }
 
+TEST_CASE("Should sum the quantities of overlapping additions and subtract removals") {
+  const auto tmpdir{temporary_directory("quantities")};
+  std::mt19937 random{42};
+  std::map<dldi::TermTriple, std::size_t> expected;
+  std::vector<std::filesystem::path> additions;
+  for (auto i{0}; i < 3; i++) {
+    std::map<dldi::TermTriple, std::size_t> statements;
+    for (auto j{0}; j < 200; j++) {
+      const dldi::TermTriple triple{"http://example.com/s" + std::to_string(random() % 10),
+                                    "http://example.com/p" + std::to_string(random() % 3),
+                                    "\"" + std::to_string(random() % 10) + "\""};
+      statements[triple] += 1 + random() % 3;
+    }
+    for (const auto& [triple, quantity]: statements) {
+      expected[triple] += quantity;
+    }
+    additions.push_back(tmpdir / ("add-" + std::to_string(i) + ".dldi"));
+    dldi::DLDI::from_statements({statements.begin(), statements.end()}, additions.back());
+  }
+  // remove every third triple, either in part or entirely.
+  std::vector<std::pair<dldi::TermTriple, std::size_t>> removals;
+  auto i{0};
+  for (auto& [triple, quantity]: expected) {
+    if (i++ % 3 == 0) {
+      const auto removed{i % 2 == 0 ? quantity : quantity / 2 + 1};
+      removals.emplace_back(triple, removed);
+      quantity -= removed;
+    }
+  }
+  dldi::DLDI::from_statements(removals, tmpdir / "rem.dldi");
+
+  const auto order_preserving_ids{GENERATE(true, false)};
+  const auto num_threads{GENERATE(1, 4)};
+  dldi::DLDI::compose(additions, {tmpdir / "rem.dldi"}, tmpdir / "composed.dldi", order_preserving_ids, 0, num_threads);
+
+  std::vector<std::string> expected_statements;
+  for (const auto& [triple, quantity]: expected) {
+    if (quantity > 0) {
+      const auto& [subject, predicate, object]{triple};
+      expected_statements.push_back(subject + " " + predicate + " " + object + " " + std::to_string(quantity));
+    }
+  }
+  REQUIRE(expected_statements.size() < expected.size());
+  std::sort(expected_statements.begin(), expected_statements.end());
+  for (const auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
+    auto actual{all_statements(tmpdir / "composed.dldi", order)};
+    std::sort(actual.begin(), actual.end());
+    REQUIRE(actual == expected_statements);
+  }
+  std::filesystem::remove_all(tmpdir);
+}
+
+TEST_CASE("Should compose the same files on one thread as on several") {
+  const auto tmpdir{temporary_directory("threads")};
+  for (const std::string name: {"add-1", "add-2", "rem-1", "rem-2"}) {
+    dldi::DLDI::from_ptld("data/" + name + ".ttl", tmpdir / (name + ".dldi"), "https://example.org/");
+  }
+  const auto order_preserving_ids{GENERATE(true, false)};
+  for (const auto num_threads: {1, 8}) {
+    dldi::DLDI::compose(std::vector<std::filesystem::path>{tmpdir / "add-1.dldi", tmpdir / "add-2.dldi"},
+                        std::vector<std::filesystem::path>{tmpdir / "rem-1.dldi", tmpdir / "rem-2.dldi"},
+                        tmpdir / ("composed-" + std::to_string(num_threads) + ".dldi"),
+                        order_preserving_ids,
+                        0,
+                        num_threads);
+  }
+  std::size_t num_files{0};
+  for (const auto& entry: std::filesystem::directory_iterator{tmpdir / "composed-1.dldi"}) {
+    std::ifstream single{entry.path(), std::ios::binary};
+    std::ifstream several{tmpdir / "composed-8.dldi" / entry.path().filename(), std::ios::binary};
+    REQUIRE(several.good());
+    const std::string single_bytes{std::istreambuf_iterator<char>{single}, {}};
+    const std::string several_bytes{std::istreambuf_iterator<char>{several}, {}};
+    REQUIRE(single_bytes == several_bytes);
+    num_files++;
+  }
+  REQUIRE(num_files > 0);
+  std::filesystem::remove_all(tmpdir);
+}
+
+TEST_CASE("Should report the terms of removals which none of the additions has") {
+  const auto tmpdir{temporary_directory("missing_removal")};
+  dldi::DLDI::from_statements({{{"http://example.com/s", "http://example.com/p", "\"a\""}, 1}}, tmpdir / "add-1.dldi");
+  dldi::DLDI::from_statements({{{"http://example.com/s", "http://example.com/p", "\"b\""}, 1}}, tmpdir / "add-2.dldi");
+  dldi::DLDI::from_statements({{{"http://example.com/s", "http://example.com/p", "\"c\""}, 1}}, tmpdir / "rem.dldi");
+  const auto order_preserving_ids{GENERATE(true, false)};
+  // the error is raised on one of the threads merging the dictionaries.
+  const auto num_threads{GENERATE(1, 3)};
+  std::string message;
+  try {
+    dldi::DLDI::compose(std::vector<std::filesystem::path>{tmpdir / "add-1.dldi", tmpdir / "add-2.dldi"},
+                        std::vector<std::filesystem::path>{tmpdir / "rem.dldi"},
+                        tmpdir / "composed.dldi",
+                        order_preserving_ids,
+                        0,
+                        num_threads);
+  } catch (const std::runtime_error& error) {
+    message = error.what();
+  }
+  REQUIRE(message.find("object `\"c\"` of " + (tmpdir / "rem.dldi").string()) != std::string::npos);
+  std::filesystem::remove_all(tmpdir);
+}
+
 TEST_CASE("Should handle terms which are strict prefixes of another") {
   const auto tmpdir{temporary_directory("prefixes")};
   SECTION("case 1") {
@@ -188,3 +360,1120 @@ TEST_CASE("Should query merged dldi") {
     REQUIRE(num_results == 1);
   }
 }
+
+TEST_CASE("Should assign term IDs in lexicographic order") {
+  const auto tmpdir{temporary_directory("ordered")};
+  const bool order_preserving_ids = GENERATE(true, false);
+
+  dldi::DLDI::from_ptld("data/add-1.ttl", tmpdir / "add-1.dldi", "https://example.org/");
+  dldi::DLDI::from_ptld("data/add-2.ttl", tmpdir / "add-2.dldi", "https://example.org/");
+  dldi::DLDI::compose(std::vector<std::filesystem::path>{tmpdir / "add-1.dldi", tmpdir / "add-2.dldi"},
+                      std::vector<std::filesystem::path>{},
+                      tmpdir / "merged.dldi",
+                      order_preserving_ids);
+
+  dldi::DLDI dldi{tmpdir / "merged.dldi"};
+  dldi.ensure_loaded(dldi::TripleTermPosition::subject);
+  dldi.ensure_loaded(dldi::TripleTermPosition::predicate);
+  dldi.ensure_loaded(dldi::TripleTermPosition::object);
+
+  SECTION("IDs follow term order") {
+    if (order_preserving_ids) {
+      auto it{dldi.query("", dldi::TripleTermPosition::object)};
+      std::size_t previous_id{0};
+      while (it.has_next()) {
+        const auto id{dldi.string_to_id(it.read().first, dldi::TripleTermPosition::object)};
+        REQUIRE(id > previous_id);
+        previous_id = id;
+        it.proceed();
+      }
+    }
+  }
+  SECTION("triple-pattern query 100 on a subject other than the first") {
+    const dldi::TriplePattern pattern{dldi.string_to_id("http://example.com/t4", dldi::TripleTermPosition::subject), 0, 0};
+    dldi.prepare_for_query(pattern);
+    auto it{dldi.query_ptr(pattern)};
+    auto num_results{0};
+    while (it->has_next()) {
+      ++num_results;
+      it->proceed();
+    }
+    REQUIRE(num_results == 5);
+  }
+  SECTION("triple-pattern query 011") {
+    const dldi::TriplePattern pattern{
+      0,
+      dldi.string_to_id("http://example.com/pred1", dldi::TripleTermPosition::predicate),
+      dldi.string_to_id("http://example.com/t2", dldi::TripleTermPosition::object)};
+    dldi.prepare_for_query(pattern);
+    auto it{dldi.query_ptr(pattern)};
+    auto num_results{0};
+    while (it->has_next()) {
+      ++num_results;
+      it->proceed();
+    }
+    REQUIRE(num_results == 2);
+  }
+}
+
+TEST_CASE("Should skip out-edges deleted since loading") {
+  const auto tmpdir{temporary_directory("deleted-edges")};
+  {
+    dldi::Dictionary dict;
+    for (const auto& term: {"a1", "b1", "c1", "xa", "xb", "xc"}) {
+      dict.add(term, 1);
+    }
+    dict.save(tmpdir / "terms.dictionary");
+  }
+  dldi::Dictionary dict{tmpdir / "terms.dictionary"};
+  // the first out-edges of the root and of the node after "x".
+  dict.remove("a1", 1);
+  dict.remove("xa", 1);
+
+  auto it{dict.query("")};
+  for (const auto& term: {"b1", "c1", "xb", "xc"}) {
+    REQUIRE(it.has_next());
+    REQUIRE(it.read().first == term);
+    it.proceed();
+  }
+  REQUIRE(!it.has_next());
+  REQUIRE(dict.string_to_id("xb") != 0);
+}
+
+TEST_CASE("Should query triples spanning several blocks") {
+  const auto tmpdir{temporary_directory("blocks")};
+  write_many_triples(tmpdir / "many.nt");
+  dldi::DLDI::from_ptld(tmpdir / "many.nt", tmpdir / "many-1.dldi", "https://example.org/");
+  dldi::DLDI::from_ptld(tmpdir / "many.nt", tmpdir / "many-2.dldi", "https://example.org/");
+  dldi::DLDI::compose(std::vector<std::filesystem::path>{tmpdir / "many-1.dldi", tmpdir / "many-2.dldi"},
+                      std::vector<std::filesystem::path>{},
+                      tmpdir / "merged.dldi");
+
+  dldi::DLDI dldi{tmpdir / "merged.dldi"};
+  dldi.ensure_loaded(dldi::TripleTermPosition::subject);
+  dldi.ensure_loaded(dldi::TripleTermPosition::predicate);
+  dldi.ensure_loaded(dldi::TripleTermPosition::object);
+
+  const auto count{[&dldi](const dldi::TriplePattern& pattern) {
+    dldi.prepare_for_query(pattern);
+    auto it{dldi.query_ptr(pattern)};
+    std::size_t num_results{0};
+    while (it->has_next()) {
+      REQUIRE(it->read().quantity() == 2);
+      ++num_results;
+      it->proceed();
+    }
+    REQUIRE(it->count() == num_results);
+    REQUIRE(dldi.count(pattern) == num_results);
+    return num_results;
+  }};
+
+  REQUIRE(count(dldi::TriplePattern{0, 0, 0}) == 300);
+  REQUIRE(count(dldi::TriplePattern{dldi.string_to_id("http://example.com/s13", dldi::TripleTermPosition::subject), 0, 0}) == 15);
+  REQUIRE(count(dldi::TriplePattern{0, dldi.string_to_id("http://example.com/p1", dldi::TripleTermPosition::predicate), 0}) == 100);
+  REQUIRE(count(dldi::TriplePattern{0, 0, dldi.string_to_id("\"3000\"", dldi::TripleTermPosition::object)}) == 60);
+
+  const dldi::TriplePattern p1{0, dldi.string_to_id("http://example.com/p1", dldi::TripleTermPosition::predicate), 0};
+  for (const auto& [pattern, expected]: {std::pair{p1, std::size_t{100}}, std::pair{dldi::TriplePattern{0, 0, 0}, std::size_t{300}}}) {
+    for (const std::size_t batch_size: {1, 100, 1000}) {
+      auto it{dldi.query_ptr(pattern)};
+      std::vector<dldi::QuantifiedTriple> batch(batch_size);
+      std::size_t num_results{0};
+      while (const auto n{it->next_batch(batch)}) {
+        for (std::size_t i{0}; i < n; i++) {
+          REQUIRE(batch.at(i).matched_by(pattern));
+        }
+        num_results += n;
+      }
+      REQUIRE(num_results == expected);
+      REQUIRE(!it->has_next());
+    }
+  }
+}
+
+TEST_CASE("Should count the matches of every pattern shape") {
+  const auto tmpdir{temporary_directory("count")};
+  // some combinations are left out, so that some patterns have no matches.
+  // they are split over two sources, whose IDs interleave unless IDs are reassigned.
+  {
+    std::ofstream ptld_1{tmpdir / "sparse-1.nt"};
+    std::ofstream ptld_2{tmpdir / "sparse-2.nt"};
+    for (auto s{0}; s < 40; s++) {
+      for (auto p{0}; p < 3; p++) {
+        for (auto o{0}; o < 5; o++) {
+          if ((s + p + o) % 3 != 0) {
+            (s % 2 == 0 ? ptld_1 : ptld_2) << "<http://example.com/s" << s << "> <http://example.com/p" << p << "> \"" << o << "\" .\n";
+          }
+        }
+      }
+    }
+  }
+  const bool order_preserving_ids = GENERATE(true, false);
+  dldi::DLDI::from_ptld(tmpdir / "sparse-1.nt", tmpdir / "sparse-1.dldi", "https://example.org/");
+  dldi::DLDI::from_ptld(tmpdir / "sparse-2.nt", tmpdir / "sparse-2.dldi", "https://example.org/");
+  dldi::DLDI::compose(std::vector<std::filesystem::path>{tmpdir / "sparse-1.dldi", tmpdir / "sparse-2.dldi"},
+                      std::vector<std::filesystem::path>{},
+                      tmpdir / "sparse.dldi",
+                      order_preserving_ids);
+
+  dldi::DLDI dldi{tmpdir / "sparse.dldi"};
+  dldi.ensure_loaded(dldi::TripleTermPosition::subject);
+  dldi.ensure_loaded(dldi::TripleTermPosition::predicate);
+  dldi.ensure_loaded(dldi::TripleTermPosition::object);
+  std::map<dldi::TripleOrder, std::vector<dldi::QuantifiedTriple>> orders;
+  for (const auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
+    dldi.ensure_loaded_triples(order);
+    auto it{dldi.query_ptr(order)};
+    while (it->has_next()) {
+      orders[order].push_back(it->read());
+      it->proceed();
+    }
+  }
+
+  std::vector<std::size_t> subjects{0};
+  std::vector<std::size_t> predicates{0};
+  std::vector<std::size_t> objects{0};
+  for (auto i{0}; i < 40; i++) {
+    subjects.push_back(dldi.string_to_id("http://example.com/s" + std::to_string(i), dldi::TripleTermPosition::subject));
+  }
+  for (auto i{0}; i < 3; i++) {
+    predicates.push_back(dldi.string_to_id("http://example.com/p" + std::to_string(i), dldi::TripleTermPosition::predicate));
+  }
+  for (auto i{0}; i < 5; i++) {
+    objects.push_back(dldi.string_to_id("\"" + std::to_string(i) + "\"", dldi::TripleTermPosition::object));
+  }
+
+  // the number of triples per block.
+  constexpr std::size_t block_size{128};
+  auto num_empty{0};
+  auto num_across_blocks{0};
+  for (const auto& subject: subjects) {
+    for (const auto& predicate: predicates) {
+      for (const auto& object: objects) {
+        const dldi::TriplePattern pattern{subject, predicate, object};
+        const auto& triples{orders.at(dldi::DLDI::decide_order_from_triple_pattern(pattern))};
+        std::vector<std::size_t> matches;
+        for (std::size_t i{0}; i < triples.size(); i++) {
+          if (triples.at(i).matched_by(pattern)) {
+            matches.push_back(i);
+          }
+        }
+        dldi.prepare_for_query(pattern);
+        REQUIRE(dldi.count(pattern) == matches.size());
+        REQUIRE(dldi.query_ptr(pattern)->count() == matches.size());
+        if (matches.empty()) {
+          num_empty++;
+          continue;
+        }
+        // the matches are contiguous in the chosen order.
+        REQUIRE(matches.back() - matches.front() + 1 == matches.size());
+        if (matches.front() / block_size != matches.back() / block_size) {
+          num_across_blocks++;
+        }
+      }
+    }
+  }
+  REQUIRE(num_empty > 0);
+  REQUIRE(num_across_blocks > 0);
+}
+
+TEST_CASE("Should radix sort triples like std::sort") {
+  // enough triples for the sort to split them over several threads.
+  const std::size_t num_triples = GENERATE(3, 300000);
+  std::mt19937_64 random{42};
+  dldi::TriplesWriter triples;
+  for (std::size_t i{0}; i < num_triples; i++) {
+    // mostly small IDs which share their high bytes, and some large ones.
+    const auto id{[&random]() -> std::size_t {
+      return random() % 8 == 0 ? random() % (std::size_t{1} << 40) + 1 : random() % 50 + 1;
+    }};
+    triples.add(dldi::QuantifiedTriple{id(), id(), id(), i});
+  }
+  for (const auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
+    for (const std::size_t num_threads: {1, 4}) {
+      auto expected{triples.triples()};
+      // equal keys keep their relative order, which the quantities tell apart.
+      std::stable_sort(expected.begin(), expected.end(), [order](const dldi::QuantifiedTriple& lhs, const dldi::QuantifiedTriple& rhs) {
+        return lhs.key(order) < rhs.key(order);
+      });
+      triples.radix_sort(order, num_threads);
+      REQUIRE(triples.triples().size() == expected.size());
+      REQUIRE(std::ranges::equal(triples.triples(), expected, [](const dldi::QuantifiedTriple& lhs, const dldi::QuantifiedTriple& rhs) {
+        return lhs.equals(rhs) && lhs.quantity() == rhs.quantity();
+      }));
+    }
+  }
+}
+
+TEST_CASE("Should build from plain-text linked data in runs under a memory budget") {
+  const auto tmpdir{temporary_directory("spill")};
+  write_many_triples(tmpdir / "many.nt");
+  // a budget of a few KiB spills the input in dozens of runs, 0 builds it in one go.
+  const std::size_t memory_budget = GENERATE(4096, 0);
+  dldi::DLDI::from_ptld(tmpdir / "many.nt", tmpdir / "many.dldi", "https://example.org/", memory_budget);
+  REQUIRE(!std::filesystem::exists(tmpdir / "many.dldi.runs"));
+
+  dldi::DLDI dldi{tmpdir / "many.dldi"};
+  dldi.ensure_loaded(dldi::TripleTermPosition::subject);
+  dldi.ensure_loaded(dldi::TripleTermPosition::predicate);
+  dldi.ensure_loaded(dldi::TripleTermPosition::object);
+  for (const auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
+    dldi.ensure_loaded_triples(order);
+  }
+  REQUIRE(dldi.count(dldi::TriplePattern{0, 0, 0}) == 300);
+  REQUIRE(dldi.count(dldi::TriplePattern{dldi.string_to_id("http://example.com/s7", dldi::TripleTermPosition::subject), 0, 0}) == 15);
+  REQUIRE(dldi.count(dldi::TriplePattern{0, 0, dldi.string_to_id("\"4000\"", dldi::TripleTermPosition::object)}) == 60);
+  auto it{dldi.query("", dldi::TripleTermPosition::subject)};
+  auto num_subjects{0};
+  while (it.has_next()) {
+    REQUIRE(it.read().second == 15);
+    ++num_subjects;
+    it.proceed();
+  }
+  REQUIRE(num_subjects == 20);
+}
+
+TEST_CASE("Should count the memory of terms being added") {
+  dldi::Dictionary dict;
+  std::size_t term_bytes{0};
+  for (auto i{0}; i < 1000; i++) {
+    const auto term{"http://example.com/" + std::to_string(i * 7919 % 1000)};
+    dict.add(term, 1);
+    term_bytes += term.size();
+  }
+  // the labels alone hold at least the distinct suffixes, and every term has a leaf and an edge of its own.
+  REQUIRE(dict.memory_usage() > 1000 * (sizeof(csd::LeafNode) + sizeof(csd::Edge)));
+  REQUIRE(dict.memory_usage() < 10 * term_bytes + 1000 * 1024);
+}
+
+TEST_CASE("Should keep term IDs and counts across flushes of the encoding cache") {
+  dldi::Dictionary dict;
+  dldi::TermEncodingCache cache{dict, 3};
+  std::map<std::string, std::size_t> ids;
+  std::map<std::string, std::size_t> counts;
+  std::size_t peak_memory_usage{0};
+  for (auto i{0}; i < 200; i++) {
+    // long enough not to be stored in place.
+    const auto term{"http://example.com/term/" + std::to_string(i * i % 11)};
+    const auto id{cache.add(term)};
+    if (ids.contains(term)) {
+      REQUIRE(ids.at(term) == id);
+    }
+    ids.insert({term, id});
+    counts[term]++;
+    peak_memory_usage = std::max(peak_memory_usage, cache.memory_usage());
+  }
+  cache.flush();
+  // only the empty buckets remain.
+  REQUIRE(cache.memory_usage() < peak_memory_usage);
+  REQUIRE(dict.size() == ids.size());
+  for (auto it{dict.query("")}; it.has_next(); it.proceed()) {
+    const auto [term, occurrences]{it.read()};
+    REQUIRE(dict.string_to_id(term) == ids.at(term));
+    REQUIRE(occurrences == counts.at(term));
+  }
+}
+
+TEST_CASE("Should merge dictionaries structurally") {
+  const std::vector<std::string> terms_1{"http://example.org/a", "http://example.org/abc", "http://example.org/b", "http://example.org/cat", "\"1\"", "_:b1"};
+  const std::vector<std::string> terms_2{"http://example.org/ab", "http://example.org/abc", "http://example.org/abd", "http://example.org/b", "http://example.org/cow", "http://other.org/", "\"1\"", "\"2\""};
+  dldi::Dictionary dict_1;
+  dldi::Dictionary dict_2;
+  for (const auto& term: terms_1) {
+    dict_1.add(term, 1);
+  }
+  for (const auto& term: terms_2) {
+    dict_2.add(term, 2);
+  }
+
+  const auto ids{dict_1.merge(dict_2)};
+  for (const auto& term: terms_2) {
+    const auto id_2{dict_2.string_to_id(term)};
+    REQUIRE(dict_1.id_to_string(ids.at(id_2)) == term);
+  }
+
+  std::vector<std::string> expected{terms_1};
+  expected.insert(expected.end(), terms_2.begin(), terms_2.end());
+  std::sort(expected.begin(), expected.end());
+  expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+  auto it{dict_1.query("")};
+  for (const auto& term: expected) {
+    REQUIRE(it.has_next());
+    REQUIRE(it.read().first == term);
+    const auto in_1{std::find(terms_1.begin(), terms_1.end(), term) != terms_1.end()};
+    const auto in_2{std::find(terms_2.begin(), terms_2.end(), term) != terms_2.end()};
+    const std::size_t expected_occurrences{(in_1 ? 1U : 0U) + (in_2 ? 2U : 0U)};
+    REQUIRE(it.read().second == expected_occurrences);
+    it.proceed();
+  }
+  REQUIRE(!it.has_next());
+}
+
+TEST_CASE("Should bulk-load a dictionary from sorted terms") {
+  const auto tmpdir{temporary_directory("bulk")};
+  const std::vector<std::string> terms{"\"1\"", "\"10\"", "\"2\"", "_:b1", "http://example.org/a", "http://example.org/ab", "http://example.org/abc", "http://example.org/abd", "http://example.org/b", "http://example.org/\u00e9t\u00e9", "http://other.org/"};
+  csd::TrieBuilder builder;
+  for (std::size_t i{0}; i < terms.size(); i++) {
+    builder.add(terms.at(i), i + 1);
+  }
+  builder.add(terms.back(), 1);
+  REQUIRE_THROWS(builder.add(terms.front()));
+  {
+    std::ofstream out{tmpdir / "bulk.dictionary", std::ios::binary};
+    builder.save(out);
+  }
+
+  dldi::Dictionary dict{tmpdir / "bulk.dictionary"};
+  REQUIRE(dict.has_order_preserving_ids());
+  auto it{dict.query("")};
+  for (std::size_t i{0}; i < terms.size(); i++) {
+    REQUIRE(dict.string_to_id(terms.at(i)) == i + 1);
+    REQUIRE(dict.id_to_string(i + 1) == terms.at(i));
+    REQUIRE(it.has_next());
+    REQUIRE(it.read().first == terms.at(i));
+    REQUIRE(it.read().second == (i + 1 == terms.size() ? i + 2 : i + 1));
+    it.proceed();
+  }
+  REQUIRE(!it.has_next());
+
+  // The loaded dictionary can be extended and saved like any other.
+  dict.add("http://example.org/abe", 1);
+  dict.save(tmpdir / "extended.dictionary");
+  dldi::Dictionary extended{tmpdir / "extended.dictionary"};
+  REQUIRE(extended.string_to_id("http://example.org/abe") == 9);
+  REQUIRE(extended.string_to_id("http://other.org/") == 12);
+}
+
+TEST_CASE("Should find terms with bytes beyond ASCII") {
+  const auto tmpdir{temporary_directory("non_ascii")};
+  // in byte order, where the bytes of multi-byte characters sort after all of ASCII.
+  const std::vector<std::string> terms{"ab", "a~", "a\u00e8", "a\u00e9", "a\u00e9t\u00e9", "a\u65e5", "\u00e9", "\xff\xff"};
+  {
+    dldi::Dictionary dict;
+    for (auto it{terms.rbegin()}; it != terms.rend(); it++) {
+      dict.add(*it, 1);
+    }
+    for (const auto& term: terms) {
+      REQUIRE(dict.string_to_id(term) != 0);
+    }
+    REQUIRE(dict.string_to_id("a\u00ea") == 0);
+    dict.save(tmpdir / "terms.dictionary");
+  }
+  dldi::Dictionary dict{tmpdir / "terms.dictionary"};
+  for (std::size_t i{0}; i < terms.size(); i++) {
+    REQUIRE(dict.string_to_id(terms.at(i)) == i + 1);
+  }
+  REQUIRE(dict.string_to_id("a\u00ea") == 0);
+}
+
+TEST_CASE("Should keep IDs stable across saves which leave holes") {
+  const auto tmpdir{temporary_directory("holes")};
+  std::vector<std::string> terms;
+  for (auto i{0}; i < 2000; i++) {
+    terms.push_back("http://example.org/" + std::to_string(i));
+  }
+  std::map<std::string, std::size_t> ids;
+  {
+    dldi::Dictionary dict;
+    for (const auto& term: terms) {
+      dict.add(term, 1);
+    }
+    dict.save(tmpdir / "0.dictionary");
+  }
+  {
+    dldi::Dictionary dict{tmpdir / "0.dictionary"};
+    for (const auto& term: terms) {
+      ids[term] = dict.string_to_id(term);
+    }
+  }
+
+  // Remove runs and single terms in a few rounds, adding a term in each, without renumbering.
+  for (auto round{0}; round < 3; round++) {
+    const auto from{tmpdir / (std::to_string(round) + ".dictionary")};
+    const auto to{tmpdir / (std::to_string(round + 1) + ".dictionary")};
+    {
+      dldi::Dictionary dict{from};
+      for (auto i{round}; i < 2000; i += 7 + round) {
+        if (ids.erase(terms.at(i)) > 0) {
+          dict.remove(terms.at(i), 1);
+        }
+      }
+      for (auto i{600 * round}; i < 600 * round + 100; i++) {
+        if (ids.erase(terms.at(i)) > 0) {
+          dict.remove(terms.at(i), 1);
+        }
+      }
+      const auto added{"http://example.org/added-" + std::to_string(round)};
+      ids[added] = dict.add(added, 1);
+      dict.save(to, false);
+    }
+    dldi::Dictionary dict{to};
+    REQUIRE(dict.size() == ids.size());
+    for (const auto& [term, id]: ids) {
+      REQUIRE(dict.string_to_id(term) == id);
+      REQUIRE(dict.id_to_string(id) == term);
+    }
+  }
+}
+
+TEST_CASE("Should read dictionaries saved before the header had a version") {
+  const auto tmpdir{temporary_directory("versions")};
+  const std::vector<std::string> terms{"http://example.org/a", "http://example.org/b", "http://example.org/bc", "literal"};
+  {
+    dldi::Dictionary dict;
+    for (const auto& term: terms) {
+      dict.add(term, 1);
+    }
+    dict.save(tmpdir / "current.dictionary");
+  }
+  std::string bytes;
+  {
+    std::ifstream in{tmpdir / "current.dictionary", std::ios::binary};
+    bytes.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+  }
+  constexpr std::size_t word{sizeof(std::size_t)};
+
+  // older files have neither the magic word, the version nor the flags. Trailing sections are ignored.
+  {
+    std::ofstream out{tmpdir / "old.dictionary", std::ios::binary};
+    out << bytes.substr(2 * word, 5 * word) << bytes.substr(8 * word);
+  }
+  dldi::Dictionary old{tmpdir / "old.dictionary"};
+  REQUIRE(old.size() == terms.size());
+  for (const auto& term: terms) {
+    REQUIRE(old.id_to_string(old.string_to_id(term)) == term);
+  }
+
+  {
+    auto future{bytes};
+    future[word] = 99;
+    std::ofstream out{tmpdir / "future.dictionary", std::ios::binary};
+    out << future;
+  }
+  try {
+    dldi::Dictionary future{tmpdir / "future.dictionary"};
+    FAIL("Loaded a dictionary of an unknown version");
+  } catch (const std::runtime_error& e) {
+    REQUIRE(std::string{e.what()}.find("version 99") != std::string::npos);
+  }
+}
+
+TEST_CASE("Should find out-edges by their first byte") {
+  const auto tmpdir{temporary_directory("fanout")};
+  // one out-edge of the root per first byte.
+  std::vector<std::string> terms;
+  for (auto c{'!'}; c <= '~'; c++) {
+    terms.push_back(std::string(1, c) + "term");
+  }
+  {
+    dldi::Dictionary dict;
+    for (std::size_t i{0}; i < terms.size(); i += 2) {
+      dict.add(terms.at(i), 1);
+    }
+    dict.save(tmpdir / "even.dictionary");
+  }
+  dldi::Dictionary dict{tmpdir / "even.dictionary"};
+  // mapped out-edges are removed, and new ones added alongside them, some with the first byte of a removed one.
+  for (std::size_t i{0}; i < terms.size(); i += 6) {
+    dict.remove(terms.at(i), 1);
+  }
+  for (std::size_t i{0}; i < terms.size(); i += 3) {
+    if (i % 2 != 0 || i % 6 == 0) {
+      dict.add(terms.at(i), 1);
+    }
+  }
+  for (std::size_t i{0}; i < terms.size(); i++) {
+    const auto present{i % 3 == 0 || i % 2 == 0};
+    REQUIRE((dict.string_to_id(terms.at(i)) != 0) == present);
+    REQUIRE(dict.string_to_id(terms.at(i).substr(0, 2)) == 0);
+  }
+  dict.save(tmpdir / "merged.dictionary");
+  dldi::Dictionary merged{tmpdir / "merged.dictionary"};
+  for (std::size_t i{0}; i < terms.size(); i++) {
+    REQUIRE((merged.string_to_id(terms.at(i)) != 0) == (i % 3 == 0 || i % 2 == 0));
+  }
+}
+
+TEST_CASE("Should extract paths deeper than fit in place") {
+  // each term is a prefix of the next, so the trie is as deep as the longest term.
+  std::vector<std::string> terms;
+  for (std::size_t length{2}; length <= 2 * csd::TriePath::INLINE_CAPACITY; length++) {
+    terms.push_back(std::string(length, 'a'));
+  }
+  dldi::Dictionary dict;
+  auto other{std::make_shared<dldi::Dictionary>()};
+  for (const auto& term: terms) {
+    dict.add(term, 1);
+    other->add(term + "b", 1);
+  }
+  for (std::size_t i{0}; i < terms.size(); i++) {
+    const auto id{dict.string_to_id(terms.at(i))};
+    REQUIRE(dict.id_to_string(id) == terms.at(i));
+    REQUIRE(other->id_to_string(other->string_to_id(terms.at(i) + "b")) == terms.at(i) + "b");
+    if (i > 0) {
+      REQUIRE(dict.compare(dict.string_to_id(terms.at(i - 1)), id) < 0);
+    }
+    // "a…a" sorts before "a…ab", which sorts after the longer "a…aa".
+    REQUIRE(dict.compare(id, other->string_to_id(terms.at(i) + "b"), other) < 0);
+    if (i + 1 < terms.size()) {
+      REQUIRE(dict.compare(dict.string_to_id(terms.at(i + 1)), other->string_to_id(terms.at(i) + "b"), other) < 0);
+    }
+  }
+}
+
+TEST_CASE("Should decode many IDs into a reused buffer") {
+  const auto tmpdir{temporary_directory("decode")};
+  std::vector<std::string> terms{"http://example.org/a", "http://example.org/ab", "http://example.org/abc", "http://example.org/b", "http://other.org/", "\"1\"", "_:b1"};
+  for (auto i{0}; i < 100; i++) {
+    terms.push_back("http://example.org/" + std::to_string(i * 37 % 100));
+  }
+  {
+    dldi::Dictionary dict;
+    for (const auto& term: terms) {
+      dict.add(term, 1);
+    }
+    dict.save(tmpdir / "terms.dictionary", false);
+  }
+  dldi::Dictionary dict{tmpdir / "terms.dictionary"};
+  std::vector<std::size_t> ids;
+  std::vector<std::string> expected;
+  // unsorted, with repetitions.
+  for (std::size_t i{0}; i < 3 * terms.size(); i++) {
+    const auto& term{terms.at(i * 11 % terms.size())};
+    ids.push_back(dict.string_to_id(term));
+    expected.push_back(term);
+  }
+
+  std::string buffer{"kept"};
+  std::vector<std::string_view> decoded;
+  dict.decode(ids, buffer, decoded);
+  REQUIRE(buffer.starts_with("kept"));
+  REQUIRE(decoded.size() == expected.size());
+  for (std::size_t i{0}; i < expected.size(); i++) {
+    REQUIRE(decoded.at(i) == expected.at(i));
+  }
+
+  buffer.clear();
+  for (std::size_t i{0}; i < terms.size(); i++) {
+    dict.append_string(dict.string_to_id(terms.at(i)), buffer);
+  }
+  std::string concatenated;
+  for (const auto& term: terms) {
+    concatenated += term;
+  }
+  REQUIRE(buffer == concatenated);
+}
+
+TEST_CASE("Should build terms along the traversal when iterating") {
+  const auto tmpdir{temporary_directory("traversal")};
+  std::vector<std::string> terms{"http://example.org/a", "http://example.org/ab", "http://example.org/abc", "http://example.org/b", "http://other.org/", "\"1\"", "_:b1"};
+  for (auto i{0}; i < 100; i++) {
+    terms.push_back("http://example.org/" + std::to_string(i * 37 % 100));
+  }
+  {
+    dldi::Dictionary dict;
+    for (const auto& term: terms) {
+      dict.add(term, 1);
+    }
+    dict.save(tmpdir / "terms.dictionary");
+  }
+  dldi::Dictionary dict{tmpdir / "terms.dictionary"};
+  // terms added since loading are in the buffers, and split edges which are mapped.
+  for (const auto& term: {"http://example.org/aa", "http://example.org/10x", "http://exa"}) {
+    dict.add(term, 1);
+    terms.push_back(term);
+  }
+  std::sort(terms.begin(), terms.end());
+
+  for (const std::string prefix: {"", "http://", "http://example.org/", "http://example.org/a", "http://example.org/1", "http://exa", "_:b1"}) {
+    auto it{dict.query(prefix)};
+    for (const auto& term: terms) {
+      if (!term.starts_with(prefix)) {
+        continue;
+      }
+      REQUIRE(it.has_next());
+      REQUIRE(it.read().first == term);
+      REQUIRE(dict.id_to_string(it.id()) == term);
+      it.proceed();
+    }
+    REQUIRE(!it.has_next());
+  }
+}
+
+TEST_CASE("Should parse N-Triples split in many small chunks") {
+  const auto directory{temporary_directory("parallel_line_parser")};
+  const auto path{directory / "many.nt"};
+  std::vector<std::string> expected;
+  {
+    std::ofstream ptld{path};
+    for (auto i{0}; i < 1000; i++) {
+      // every tenth literal is longer than a chunk.
+      const std::string literal{i % 10 == 0 ? std::string(300, 'x') + std::to_string(i) : std::to_string(i)};
+      ptld << "<http://example.com/s" << i % 37 << "> <http://example.com/p> \"" << literal << "\" .\n";
+      expected.push_back("http://example.com/s" + std::to_string(i % 37) + " \"" + literal + "\"");
+    }
+  }
+  std::sort(expected.begin(), expected.end());
+  const auto num_threads{GENERATE(1, 4)};
+  const auto chunk_size{GENERATE(1, 64, 100000)};
+  std::vector<std::string> parsed;
+  rdf::ParallelLineParser{
+    path,
+    [&parsed](const std::string& subject, [[maybe_unused]] const std::string& predicate, const std::string& object) {
+      parsed.push_back(subject + " " + object);
+    },
+    "https://example.com/",
+    rdf::SerializationFormat::NTriples,
+    static_cast<std::size_t>(num_threads),
+    static_cast<std::size_t>(chunk_size)};
+  std::sort(parsed.begin(), parsed.end());
+  REQUIRE(parsed == expected);
+
+  const auto invalid_path{directory / "invalid.nt"};
+  {
+    std::ofstream ptld{invalid_path};
+    for (auto i{0}; i < 1000; i++) {
+      ptld << (i == 500 ? "<http://example.com/s> <http://example.com/p> <http://example.com/o>\n" : "<http://example.com/s> <http://example.com/p> <http://example.com/o> .\n");
+    }
+  }
+  REQUIRE_THROWS(rdf::ParallelLineParser{
+    invalid_path,
+    []([[maybe_unused]] const std::string& subject, [[maybe_unused]] const std::string& predicate, [[maybe_unused]] const std::string& object) {},
+    "https://example.com/",
+    rdf::SerializationFormat::NTriples,
+    static_cast<std::size_t>(num_threads),
+    static_cast<std::size_t>(chunk_size)});
+  std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("Should compose plain-text linked data alongside DLDIs") {
+  const auto tmpdir{temporary_directory("mixed")};
+  for (const std::string name: {"add-1", "add-2", "rem-1", "rem-2"}) {
+    dldi::DLDI::from_ptld("data/" + name + ".ttl", tmpdir / (name + ".dldi"), "https://example.com/");
+  }
+  dldi::DLDI::compose(std::vector<std::filesystem::path>{tmpdir / "add-1.dldi", tmpdir / "add-2.dldi"},
+                      std::vector<std::filesystem::path>{tmpdir / "rem-1.dldi", tmpdir / "rem-2.dldi"},
+                      tmpdir / "from-dldis.dldi");
+  dldi::DLDI::compose(std::vector<std::filesystem::path>{tmpdir / "add-1.dldi", "data/add-2.ttl"},
+                      std::vector<std::filesystem::path>{"data/rem-1.ttl", tmpdir / "rem-2.dldi"},
+                      tmpdir / "mixed.dldi");
+
+  for (const auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
+    const auto expected{all_statements(tmpdir / "from-dldis.dldi", order)};
+    REQUIRE(!expected.empty());
+    REQUIRE(all_statements(tmpdir / "mixed.dldi", order) == expected);
+  }
+}
+
+TEST_CASE("Should stream plain-text linked data which is sorted by subject") {
+  const auto tmpdir{temporary_directory("sorted")};
+  const std::size_t memory_budget = GENERATE(0, 1024);
+  // Subjects in lexicographic order, each with statements in no particular order, and one duplicate.
+  {
+    std::ofstream ptld{tmpdir / "data.sorted.nt"};
+    for (const std::string subject: {"_:b1", "http://example.com/a", "http://example.com/a/b", "http://example.com/b"}) {
+      const auto subject_str{subject.starts_with("_:") ? subject : "<" + subject + ">"};
+      for (auto p{2}; p >= 0; p--) {
+        for (auto o{0}; o < 40; o++) {
+          ptld << subject_str << " <http://example.com/p" << p << "> \"" << (o * 7) % 40 << "\" .\n";
+        }
+      }
+    }
+    ptld << "<http://example.com/b> <http://example.com/p0> \"3\" .\n";
+  }
+  std::filesystem::copy_file(tmpdir / "data.sorted.nt", tmpdir / "data.nt");
+  dldi::DLDI::from_ptld(tmpdir / "data.nt", tmpdir / "expected.dldi", "https://example.org/");
+
+  SECTION("sorted input is streamed") {
+    dldi::DLDI::from_sorted_ptld(tmpdir / "data.sorted.nt", tmpdir / "sorted.dldi", "https://example.org/", memory_budget);
+  }
+  SECTION("input sorted like N-Triples lines is streamed") {
+    // `<http://example.com/a/b>` sorts before `<http://example.com/a>`, and IRIs before blank nodes. 
+    std::vector<std::string> lines;
+    {
+      std::ifstream in{tmpdir / "data.sorted.nt"};
+      for (std::string line; std::getline(in, line);) {
+        lines.push_back(line);
+      }
+    }
+    std::sort(lines.begin(), lines.end());
+    {
+      std::ofstream out{tmpdir / "data.sorted.nt", std::ios::trunc};
+      for (const auto& line: lines) {
+        out << line << "\n";
+      }
+    }
+    dldi::DLDI::from_sorted_ptld(tmpdir / "data.sorted.nt", tmpdir / "sorted.dldi", "https://example.org/", memory_budget);
+  }
+  SECTION("unsorted input is rejected, and built like unsorted input instead") {
+    std::vector<std::string> lines;
+    {
+      std::ifstream in{tmpdir / "data.sorted.nt"};
+      for (std::string line; std::getline(in, line);) {
+        lines.push_back(line);
+      }
+    }
+    std::shuffle(lines.begin(), lines.end(), std::mt19937{42});
+    {
+      std::ofstream out{tmpdir / "data.sorted.nt", std::ios::trunc};
+      for (const auto& line: lines) {
+        out << line << "\n";
+      }
+    }
+    REQUIRE_THROWS_AS(dldi::DLDI::from_sorted_ptld(tmpdir / "data.sorted.nt", tmpdir / "sorted.dldi", "https://example.org/", memory_budget), dldi::UnsortedInput);
+    REQUIRE(!std::filesystem::exists(tmpdir / "sorted.dldi"));
+    dldi::DLDI::from_ptld(tmpdir / "data.sorted.nt", tmpdir / "sorted.dldi", "https://example.org/", memory_budget);
+  }
+  REQUIRE(!std::filesystem::exists(tmpdir / "sorted.dldi.runs"));
+  for (const auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
+    const auto expected{all_statements(tmpdir / "expected.dldi", order)};
+    REQUIRE(expected.size() == 480);
+    REQUIRE(all_statements(tmpdir / "sorted.dldi", order) == expected);
+  }
+}
+
+TEST_CASE("Should sort terms in runs under a memory budget") {
+  const auto tmpdir{temporary_directory("term_sorter")};
+  const std::size_t memory_budget = GENERATE(0, 1024);
+  dldi::ExternalTermSorter sorter{tmpdir / "runs", "terms", memory_budget};
+  std::vector<std::tuple<std::string, std::size_t, std::size_t>> expected;
+  for (std::size_t id{1}; id <= 1000; id++) {
+    const auto term{"http://example.com/" + std::to_string(id * 7919 % 1000) + "/long-enough-not-to-be-stored-in-place"};
+    sorter.add(term, id, id % 5);
+    expected.emplace_back(term, id, id % 5);
+  }
+  if (memory_budget > 0) {
+    REQUIRE(std::distance(std::filesystem::directory_iterator{tmpdir / "runs"}, std::filesystem::directory_iterator{}) > 10);
+  }
+  std::sort(expected.begin(), expected.end());
+  std::vector<std::tuple<std::string, std::size_t, std::size_t>> actual;
+  sorter.for_each([&actual](const std::string& term, const std::size_t& id, const std::size_t& occurrences) {
+    actual.emplace_back(term, id, occurrences);
+  });
+  REQUIRE(actual == expected);
+  REQUIRE((!std::filesystem::exists(tmpdir / "runs") || std::filesystem::is_empty(tmpdir / "runs")));
+  std::filesystem::remove_all(tmpdir);
+}
+
+TEST_CASE("Should raise the errors of parser callbacks once the parser is cleaned up") {
+  const auto tmpdir{temporary_directory("parser_callback")};
+  write_many_triples(tmpdir / "data.nt");
+  std::size_t num_statements{0};
+  REQUIRE_THROWS_WITH(rdf::SerdParser(
+                        tmpdir / "data.nt",
+                        [&num_statements]([[maybe_unused]] const std::string& subject, [[maybe_unused]] const std::string& predicate, [[maybe_unused]] const std::string& object) {
+                          if (++num_statements == 10) {
+                            throw std::runtime_error("stop");
+                          }
+                        }),
+                      "stop");
+  // the reader stops at the first error.
+  REQUIRE(num_statements == 10);
+  std::filesystem::remove_all(tmpdir);
+}
+
+TEST_CASE("Should query a base DLDI with deltas applied on the fly") {
+  const auto tmpdir{temporary_directory("view")};
+  for (const std::string name: {"add-1", "add-2", "rem-1", "rem-2"}) {
+    dldi::DLDI::from_ptld("data/" + name + ".ttl", tmpdir / (name + ".dldi"), "https://example.com/");
+  }
+  dldi::DLDI::compose(std::vector<std::filesystem::path>{tmpdir / "add-1.dldi", tmpdir / "add-2.dldi"},
+                      std::vector<std::filesystem::path>{tmpdir / "rem-1.dldi", tmpdir / "rem-2.dldi"},
+                      tmpdir / "composed.dldi");
+  dldi::DLDI composed{tmpdir / "composed.dldi"};
+  dldi::DLDIView view{tmpdir / "add-1.dldi", {{tmpdir / "add-2.dldi"}, {tmpdir / "rem-1.dldi", true}, {tmpdir / "rem-2.dldi", true}}};
+
+  for (const auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
+    const auto expected{all_statements(tmpdir / "composed.dldi", order)};
+    REQUIRE(!expected.empty());
+    REQUIRE(all_statements(view, order) == expected);
+  }
+
+  for (const auto position: {dldi::TripleTermPosition::subject, dldi::TripleTermPosition::predicate, dldi::TripleTermPosition::object}) {
+    composed.ensure_loaded(position);
+    auto expected{composed.query("", position)};
+    auto actual{view.query("", position)};
+    while (expected.has_next()) {
+      REQUIRE(actual.has_next());
+      REQUIRE(actual.read() == expected.read());
+      const auto& term{actual.read().first};
+      REQUIRE(view.id_to_string(view.string_to_id(term, position), position) == term);
+      expected.proceed();
+      actual.proceed();
+    }
+    REQUIRE(!actual.has_next());
+  }
+
+  // patterns with fixed terms, including terms which only the deltas know.
+  composed.ensure_loaded_triples(dldi::TripleOrder::SPO);
+  auto triples{composed.query_ptr(dldi::TripleOrder::SPO)};
+  while (triples->has_next()) {
+    const auto triple{triples->read()};
+    const auto subject{composed.id_to_string(triple.subject(), dldi::TripleTermPosition::subject)};
+    const auto object{composed.id_to_string(triple.object(), dldi::TripleTermPosition::object)};
+    const dldi::TriplePattern composed_pattern{triple.subject(), 0, triple.object()};
+    const dldi::TriplePattern view_pattern{view.string_to_id(subject, dldi::TripleTermPosition::subject), 0, view.string_to_id(object, dldi::TripleTermPosition::object)};
+    composed.prepare_for_query(composed_pattern);
+    std::vector<std::string> expected;
+    auto it{composed.query_ptr(composed_pattern)};
+    while (it->has_next()) {
+      expected.push_back(composed.id_to_string(it->read().predicate(), dldi::TripleTermPosition::predicate) + " " + std::to_string(it->read().quantity()));
+      it->proceed();
+    }
+    std::vector<std::string> actual;
+    auto view_it{view.query_ptr(view_pattern)};
+    while (view_it->has_next()) {
+      actual.push_back(view.id_to_string(view_it->read().predicate(), dldi::TripleTermPosition::predicate) + " " + std::to_string(view_it->read().quantity()));
+      view_it->proceed();
+    }
+    REQUIRE(actual == expected);
+    triples->proceed();
+  }
+
+  // removals leave gaps in a base whose IDs aren't order-preserving, which terms of the deltas mustn't take.
+  const auto statement{[](const std::string& subject) -> std::pair<dldi::TermTriple, std::size_t> {
+    return {{"http://a/" + subject, "http://a/p", "http://a/o"}, 1};
+  }};
+  dldi::DLDI::from_statements({statement("s1"), statement("s2"), statement("s3")}, tmpdir / "gapped-add.dldi");
+  dldi::DLDI::from_statements({statement("s1")}, tmpdir / "gapped-rem.dldi");
+  dldi::DLDI::compose(std::vector<std::filesystem::path>{tmpdir / "gapped-add.dldi"}, std::vector<std::filesystem::path>{tmpdir / "gapped-rem.dldi"}, tmpdir / "gapped.dldi", false);
+  dldi::DLDI::from_statements({statement("s9")}, tmpdir / "gapped-delta.dldi");
+  dldi::DLDIView gapped{tmpdir / "gapped.dldi", {{tmpdir / "gapped-delta.dldi"}}};
+  gapped.ensure_loaded_triples(dldi::TripleOrder::SPO);
+  const auto s3{gapped.string_to_id("http://a/s3", dldi::TripleTermPosition::subject)};
+  const auto s9{gapped.string_to_id("http://a/s9", dldi::TripleTermPosition::subject)};
+  REQUIRE(s3 != 0);
+  REQUIRE(s9 != 0);
+  REQUIRE(s3 != s9);
+  REQUIRE(gapped.id_to_string(s3, dldi::TripleTermPosition::subject) == "http://a/s3");
+  REQUIRE(gapped.id_to_string(s9, dldi::TripleTermPosition::subject) == "http://a/s9");
+  for (const auto subject: {s3, s9}) {
+    auto it{gapped.query_ptr(dldi::TriplePattern{subject, 0, 0})};
+    REQUIRE(it->has_next());
+    REQUIRE(it->read().subject() == subject);
+    it->proceed();
+    REQUIRE(!it->has_next());
+  }
+  REQUIRE(all_statements(gapped, dldi::TripleOrder::SPO).size() == 3);
+}
+
+TEST_CASE("Should compact a stack of deltas in the background") {
+  const auto tmpdir{temporary_directory("compaction")};
+  for (const std::string name: {"add-1", "add-2", "rem-1", "rem-2"}) {
+    dldi::DLDI::from_ptld("data/" + name + ".ttl", tmpdir / (name + ".dldi"), "https://example.com/");
+  }
+  dldi::DLDI::compose(std::vector<std::filesystem::path>{tmpdir / "add-1.dldi", tmpdir / "add-2.dldi"},
+                      std::vector<std::filesystem::path>{tmpdir / "rem-1.dldi", tmpdir / "rem-2.dldi"},
+                      tmpdir / "composed.dldi");
+  const auto check_view{[&tmpdir](const dldi::DeltaStack& stack) {
+    auto view{stack.view()};
+    for (const auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
+      REQUIRE(all_statements(view, order) == all_statements(tmpdir / "composed.dldi", order));
+    }
+  }};
+
+  dldi::DeltaStack::create(tmpdir / "stack", tmpdir / "add-1.dldi");
+  {
+    dldi::DeltaStack stack{tmpdir / "stack"};
+    stack.push(tmpdir / "add-2.dldi");
+    stack.push(tmpdir / "rem-1.dldi", true);
+    stack.push(tmpdir / "rem-2.dldi", true);
+    REQUIRE(stack.layers().size() == 4);
+    check_view(stack);
+
+    // the two removals form a tier, while the deltas together aren't large enough to fold into the base.
+    dldi::CompactionPolicy policy;
+    policy.tier_ratio = 1000;
+    policy.min_tier_deltas = 2;
+    policy.max_delta_ratio = 1000;
+    {
+      dldi::Compactor compactor{stack, policy};
+      compactor.wait_idle();
+    }
+    const auto layers{stack.layers()};
+    REQUIRE(layers.size() == 3);
+    REQUIRE(!layers[1].removal);
+    REQUIRE(layers[2].removal);
+    check_view(stack);
+  }
+
+  // the manifest is picked up when the stack is reopened.
+  dldi::DeltaStack stack{tmpdir / "stack"};
+  REQUIRE(stack.layers().size() == 3);
+  {
+    // a view made before the compaction loads its orders from the replaced layers after it.
+    auto view{stack.view()};
+    dldi::CompactionPolicy policy;
+    policy.max_deltas = 1;
+    {
+      dldi::Compactor compactor{stack, policy};
+      compactor.wait_idle();
+    }
+    REQUIRE(stack.layers().size() == 1);
+    REQUIRE(std::distance(std::filesystem::directory_iterator{tmpdir / "stack"}, std::filesystem::directory_iterator{}) == 5);
+    for (const auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
+      REQUIRE(all_statements(view, order) == all_statements(tmpdir / "composed.dldi", order));
+    }
+  }
+  check_view(stack);
+  REQUIRE(std::distance(std::filesystem::directory_iterator{tmpdir / "stack"}, std::filesystem::directory_iterator{}) == 2);
+}
+
+TEST_CASE("Should pace the writes of a composition") {
+  const auto tmpdir{temporary_directory("throttle")};
+  for (const std::string name: {"add-1", "add-2"}) {
+    dldi::DLDI::from_ptld("data/" + name + ".ttl", tmpdir / (name + ".dldi"), "https://example.com/");
+  }
+  const std::vector<std::filesystem::path> additions{tmpdir / "add-1.dldi", tmpdir / "add-2.dldi"};
+  dldi::DLDI::compose(additions, {}, tmpdir / "unthrottled.dldi");
+  std::size_t size{0};
+  for (const auto& entry: std::filesystem::directory_iterator{tmpdir / "unthrottled.dldi"}) {
+    size += entry.file_size();
+  }
+
+  // at twice the size per second, the blocks and dictionaries alone take a good part of half a second.
+  dldi::WriteThrottle throttle{2 * size};
+  const auto started{std::chrono::steady_clock::now()};
+  dldi::DLDI::compose(additions, {}, tmpdir / "throttled.dldi", true, 0, 4, &throttle);
+  REQUIRE(std::chrono::steady_clock::now() - started >= std::chrono::milliseconds{200});
+  for (const auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
+    REQUIRE(all_statements(tmpdir / "throttled.dldi", order) == all_statements(tmpdir / "unthrottled.dldi", order));
+  }
+  std::filesystem::remove_all(tmpdir);
+}
+
+TEST_CASE("Should apply live updates to a stack through a write-ahead log") {
+  const auto tmpdir{temporary_directory("live")};
+  for (const std::string name: {"add-1", "add-2", "rem-1", "rem-2"}) {
+    dldi::DLDI::from_ptld("data/" + name + ".ttl", tmpdir / (name + ".dldi"), "https://example.com/");
+  }
+  dldi::DLDI::compose(std::vector<std::filesystem::path>{tmpdir / "add-1.dldi", tmpdir / "add-2.dldi"},
+                      std::vector<std::filesystem::path>{tmpdir / "rem-1.dldi", tmpdir / "rem-2.dldi"},
+                      tmpdir / "composed.dldi");
+  const auto check_view{[&tmpdir](const dldi::DeltaStack& stack) {
+    auto view{stack.view()};
+    for (const auto order: dldi::EnumMapping::TRIPLE_ORDERS) {
+      REQUIRE(all_statements(view, order) == all_statements(tmpdir / "composed.dldi", order));
+    }
+  }};
+  // the statements of a DLDI, once per occurrence.
+  const auto term_triples{[&tmpdir](const std::string& name) {
+    dldi::DLDI dldi{tmpdir / (name + ".dldi")};
+    dldi.ensure_loaded(dldi::TripleTermPosition::subject);
+    dldi.ensure_loaded(dldi::TripleTermPosition::predicate);
+    dldi.ensure_loaded(dldi::TripleTermPosition::object);
+    dldi.ensure_loaded_triples(dldi::TripleOrder::SPO);
+    std::vector<dldi::TermTriple> result;
+    auto it{dldi.query_ptr(dldi::TripleOrder::SPO)};
+    while (it->has_next()) {
+      const auto triple{it->read()};
+      for (std::size_t i{0}; i < triple.quantity(); i++) {
+        result.emplace_back(dldi.id_to_string(triple.subject(), dldi::TripleTermPosition::subject),
+                            dldi.id_to_string(triple.predicate(), dldi::TripleTermPosition::predicate),
+                            dldi.id_to_string(triple.object(), dldi::TripleTermPosition::object));
+      }
+      it->proceed();
+    }
+    return result;
+  }};
+
+  dldi::DeltaStack::create(tmpdir / "stack", tmpdir / "add-1.dldi");
+  const std::size_t flush_threshold = GENERATE(3, 1000);
+  {
+    dldi::DeltaStack stack{tmpdir / "stack", flush_threshold};
+    for (const auto& [s, p, o]: term_triples("add-2")) {
+      stack.insert(s, p, o);
+    }
+    for (const auto name: {"rem-1", "rem-2"}) {
+      for (const auto& [s, p, o]: term_triples(name)) {
+        stack.remove(s, p, o);
+      }
+    }
+    // removals of triples the stack doesn't hold are rejected before they reach the log.
+    const auto [s, p, o]{term_triples("add-2").front()};
+    REQUIRE_THROWS(stack.remove(s, p, "<https://example.com/missing>"));
+    check_view(stack);
+  }
+  // the buffered changes are replayed from the log after a restart.
+  dldi::DeltaStack stack{tmpdir / "stack", flush_threshold};
+  check_view(stack);
+  // a flush which fails to replace the manifest leaves the stack as it was.
+  const auto num_entries{[&tmpdir]() {
+    return std::distance(std::filesystem::directory_iterator{tmpdir / "stack"}, std::filesystem::directory_iterator{});
+  }};
+  std::filesystem::create_directory(tmpdir / "stack" / "manifest.tmp");
+  const auto num_layers{stack.layers().size()};
+  const auto num_entries_before{num_entries()};
+  REQUIRE_THROWS(stack.flush());
+  REQUIRE(stack.layers().size() == num_layers);
+  REQUIRE(num_entries() == num_entries_before);
+  std::filesystem::remove(tmpdir / "stack" / "manifest.tmp");
+  check_view(stack);
+  stack.flush();
+  REQUIRE(stack.layers().size() > 1);
+  check_view(stack);
+  REQUIRE(std::ranges::none_of(std::filesystem::directory_iterator{tmpdir / "stack"}, [](const auto& entry) {
+    return entry.path().extension() == ".wal";
+  }));
+}
+
+TEST_CASE("Should save statistics along with a DLDI") {
+  const auto tmpdir{temporary_directory("statistics")};
+  write_many_triples(tmpdir / "data.nt");
+  dldi::DLDI::from_ptld(tmpdir / "data.nt", tmpdir / "data.dldi", "https://example.org/");
+  REQUIRE(std::filesystem::exists(dldi::Statistics::statistics_file_path(tmpdir / "data.dldi")));
+
+  dldi::DLDI dldi{tmpdir / "data.dldi"};
+  dldi.ensure_loaded_statistics();
+  const auto& statistics{dldi.statistics()};
+  REQUIRE(statistics.triples == 300);
+  REQUIRE(statistics.predicates.size() == 3);
+  for (const auto& [predicate, stats]: statistics.predicates) {
+    REQUIRE(stats.triples == 100);
+    REQUIRE(stats.distinct_subjects == 20);
+    REQUIRE(stats.distinct_objects == 5);
+  }
+  // 20 subjects with 15 occurrences, 3 predicates with 100, 5 objects with 60.
+  REQUIRE(statistics.occurrence_histograms[0] == std::vector<std::size_t>{0, 0, 0, 20});
+  REQUIRE(statistics.occurrence_histograms[1] == std::vector<std::size_t>{0, 0, 0, 0, 0, 0, 3});
+  REQUIRE(statistics.occurrence_histograms[2] == std::vector<std::size_t>{0, 0, 0, 0, 0, 5});
+  REQUIRE(statistics.characteristic_sets.size() == 1);
+  REQUIRE(statistics.characteristic_sets[0].predicates.size() == 3);
+  REQUIRE(statistics.characteristic_sets[0].subjects == 20);
+  REQUIRE(statistics.characteristic_sets[0].triples == 300);
+
+  // composing saves the statistics of the result.
+  dldi::DLDI::from_ptld("data/add-1.ttl", tmpdir / "add-1.dldi", "https://example.com/");
+  dldi::DLDI::compose(std::vector<std::filesystem::path>{tmpdir / "data.dldi", tmpdir / "add-1.dldi"}, {}, tmpdir / "composed.dldi");
+  const auto saved{dldi::Statistics::load(dldi::Statistics::statistics_file_path(tmpdir / "composed.dldi"))};
+  const auto computed{dldi::Statistics::compute(tmpdir / "composed.dldi")};
+  REQUIRE(saved.triples == 300 + all_statements(tmpdir / "add-1.dldi", dldi::TripleOrder::SPO).size());
+  REQUIRE(saved.triples == computed.triples);
+  REQUIRE(saved.predicates.size() == computed.predicates.size());
+  REQUIRE(saved.occurrence_histograms == computed.occurrence_histograms);
+  REQUIRE(saved.characteristic_sets.size() == computed.characteristic_sets.size());
+  REQUIRE(saved.characteristic_sets.size() > 1);
+  for (std::size_t i{0}; i < saved.characteristic_sets.size(); i++) {
+    REQUIRE(saved.characteristic_sets[i].predicates == computed.characteristic_sets[i].predicates);
+    REQUIRE(saved.characteristic_sets[i].subjects == computed.characteristic_sets[i].subjects);
+    REQUIRE(saved.characteristic_sets[i].triples == computed.characteristic_sets[i].triples);
+  }
+
+  // only so many characteristic sets are counted at a time, which keeps the common ones.
+  dldi::StatisticsCollector collector;
+  constexpr std::size_t num_rare_sets{2 * dldi::StatisticsCollector::MAX_COUNTED_CHARACTERISTIC_SETS};
+  for (std::size_t subject{1}; subject <= 2 * num_rare_sets; subject++) {
+    if (subject % 2 == 1) {
+      collector.add(dldi::TripleOrder::SPO, dldi::QuantifiedTriple{subject, 1, 1, 1});
+      collector.add(dldi::TripleOrder::SPO, dldi::QuantifiedTriple{subject, 2, 1, 1});
+    } else {
+      collector.add(dldi::TripleOrder::SPO, dldi::QuantifiedTriple{subject, 2 + subject, 1, 1});
+    }
+  }
+  const auto collected{collector.finish(tmpdir / "data.dldi")};
+  REQUIRE(collected.characteristic_sets.size() == dldi::Statistics::MAX_CHARACTERISTIC_SETS);
+  REQUIRE(collected.characteristic_sets[0].predicates == std::vector<std::size_t>{1, 2});
+  REQUIRE(collected.characteristic_sets[0].subjects == num_rare_sets);
+  REQUIRE(collected.characteristic_sets[0].triples == 2 * num_rare_sets);
+  REQUIRE(collected.characteristic_sets[1].subjects < num_rare_sets / 1000);
+}